@@ -9,6 +9,9 @@ public class ClimbingSystem : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PublicDependencyModuleNames.AddRange(new string[] {
-			"Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "EnhancedInput", "MotionWarping" });
+			"Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "EnhancedInput", "MotionWarping",
+			"MassEntity", "MassCommon", "MassSpawner", "StructUtils", "NavigationSystem", "AIModule" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "AnimationBudgetAllocator" });
 	}
 }
@@ -2,6 +2,20 @@
 
 #include "ClimbingSystem.h"
 #include "Modules/ModuleManager.h"
+#include "Debug/ClimbLog.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ClimbingSystem, "ClimbingSystem" );
- 
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogClimbing);
+
+class FClimbingSystemModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override {
+		ClimbLog::RegisterCrashDump();
+	}
+
+	virtual void ShutdownModule() override {
+		ClimbLog::UnregisterCrashDump();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FClimbingSystemModule, ClimbingSystem, "ClimbingSystem" );
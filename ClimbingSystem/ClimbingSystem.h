@@ -3,3 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+// climb logs above this verbosity are compiled out entirely, shipping keeps warnings and errors only
+#ifndef CLIMB_LOG_COMPILE_VERBOSITY
+	#if UE_BUILD_SHIPPING
+		#define CLIMB_LOG_COMPILE_VERBOSITY Warning
+	#else
+		#define CLIMB_LOG_COMPILE_VERBOSITY All
+	#endif
+#endif
+
+CLIMBINGSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogClimbing, Log, CLIMB_LOG_COMPILE_VERBOSITY);
@@ -10,6 +10,8 @@
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "MotionWarpingComponent.h"
+#include "InputMappingContext.h"
+#include "SkeletalMeshComponentBudgeted.h"
 
 #include "DebugHelper.h"
 
@@ -18,7 +20,9 @@
 // AClimbingSystemCharacter
 
 AClimbingSystemCharacter::AClimbingSystemCharacter(const FObjectInitializer& objectInitializer)
-	: Super(objectInitializer.SetDefaultSubobjectClass<UCustomMovementComponent>(ACharacter::CharacterMovementComponentName))
+	: Super(objectInitializer
+		.SetDefaultSubobjectClass<UCustomMovementComponent>(ACharacter::CharacterMovementComponentName)
+		.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -30,6 +34,15 @@ AClimbingSystemCharacter::AClimbingSystemCharacter(const FObjectInitializer& obj
 
 	CustomMovementComponent = Cast<UCustomMovementComponent>(GetCharacterMovement());
 
+	// Replicated locations are decoded with the receiver's own quantization level, so it has to be a class default
+	// that server and clients share. Climbers move slowly along walls, a millimetre grid is plenty for simulated proxies.
+	GetReplicatedMovement_Mutable().LocationQuantizationLevel = EVectorQuantization::RoundOneDecimal;
+
+	// the movement component feeds the animation budget allocator, it knows when a montage transition must not be skipped
+	if(auto* budgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh())) {
+		budgetedMesh->SetAutoCalculateSignificance(false);
+	}
+
 	// Configure character movement
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 500.0f, 0.0f); // ...at this rotation rate
@@ -62,6 +75,8 @@ void AClimbingSystemCharacter::BeginPlay()
 	Super::BeginPlay();
 
 	AddInputMappingContext(DefaultMappingContext, 0);
+	AddInputMappingContext(ClimbMappingContext, 1);
+	BuildClimbInputShadows();
 
 	if(CustomMovementComponent) {
 		CustomMovementComponent->OnEnterClimbStateDelegate.BindUObject(this, &ThisClass::OnPlayerEnterClimbState);
@@ -69,6 +84,16 @@ void AClimbingSystemCharacter::BeginPlay()
 	}
 }
 
+void AClimbingSystemCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	inputRecorder.Stop();
+	Super::EndPlay(EndPlayReason);
+}
+
+void AClimbingSystemCharacter::Tick(float DeltaSeconds) {
+	Super::Tick(DeltaSeconds);
+	TickInputRecorder();
+}
+
 void AClimbingSystemCharacter::AddInputMappingContext(UInputMappingContext* contextToAdd, int32 InPriority) {
 	if(!contextToAdd) { return; }
 	if(APlayerController* PlayerController = Cast<APlayerController>(Controller)) {
@@ -78,15 +103,25 @@ void AClimbingSystemCharacter::AddInputMappingContext(UInputMappingContext* cont
 	}
 }
 
-void AClimbingSystemCharacter::RemoveInputMappingContext(UInputMappingContext* contextToRemove) {
-	if(!contextToRemove) { return; }
-	if(APlayerController* PlayerController = Cast<APlayerController>(Controller)) {
-		if(UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer())) {
-			Subsystem->RemoveMappingContext(contextToRemove);
+void AClimbingSystemCharacter::BuildClimbInputShadows() {
+	climbInputShadows.Reset();
+	if(!DefaultMappingContext || !ClimbMappingContext) { return; }
+
+	// the climb context has the higher priority, so a key in both only ever triggers the climb action
+	for(const auto& climbMapping : ClimbMappingContext->GetMappings()) {
+		for(const auto& groundMapping : DefaultMappingContext->GetMappings()) {
+			if(climbMapping.Key == groundMapping.Key && climbMapping.Action && groundMapping.Action) {
+				climbInputShadows.FindOrAdd(climbMapping.Action).AddUnique(groundMapping.Action);
+			}
 		}
 	}
 }
 
+bool AClimbingSystemCharacter::ClimbActionShadows(const UInputAction* climbAction, const UInputAction* groundAction) const {
+	const auto* shadowed = climbInputShadows.Find(climbAction);
+	return shadowed && shadowed->Contains(groundAction);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -96,8 +131,8 @@ void AClimbingSystemCharacter::SetupPlayerInputComponent(class UInputComponent*
 	if (UEnhancedInputComponent* EnhancedInputComponent = CastChecked<UEnhancedInputComponent>(PlayerInputComponent)) {
 		
 		//Jumping
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Triggered, this, &ACharacter::Jump);
-		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
+		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Triggered, this, &AClimbingSystemCharacter::OnJumpActionTriggered);
+		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &AClimbingSystemCharacter::OnJumpActionCompleted);
 
 		//Moving
 		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &AClimbingSystemCharacter::HandleGroundMovementInput);
@@ -109,14 +144,35 @@ void AClimbingSystemCharacter::SetupPlayerInputComponent(class UInputComponent*
 		
 		// climb actions in climb context
 		EnhancedInputComponent->BindAction(ClimbHopAction, ETriggerEvent::Started, this, &AClimbingSystemCharacter::OnClimbHopActionStarted);
+		EnhancedInputComponent->BindAction(ClimbHopAction, ETriggerEvent::Completed, this, &AClimbingSystemCharacter::OnClimbHopActionCompleted);
 		EnhancedInputComponent->BindAction(ClimbMoveAction, ETriggerEvent::Triggered, this, &AClimbingSystemCharacter::HandleClimbMovementInput);
 	}
 }
 
+void AClimbingSystemCharacter::OnJumpActionTriggered(const FInputActionValue& Value) {
+	if(inputRecorder.IsReplaying()) { return; }
+
+	inputRecorder.Record(EClimbInputEvent::Jump, FVector2D::ZeroVector);
+	Jump();
+}
+
+void AClimbingSystemCharacter::OnJumpActionCompleted(const FInputActionValue& Value) {
+	if(inputRecorder.IsReplaying()) { return; }
+
+	inputRecorder.Record(EClimbInputEvent::StopJumping, FVector2D::ZeroVector);
+	StopJumping();
+}
+
 void AClimbingSystemCharacter::HandleGroundMovementInput(const FInputActionValue& Value) {
+	if(inputRecorder.IsReplaying()) { return; }
+
 	// input is a Vector2D
 	const FVector2D MovementVector = Value.Get<FVector2D>();
+	inputRecorder.Record(EClimbInputEvent::GroundMove, MovementVector);
+	ApplyGroundMovementInput(MovementVector);
+}
 
+void AClimbingSystemCharacter::ApplyGroundMovementInput(const FVector2D& MovementVector) {
 	if(Controller != nullptr) {
 		// find out which way is forward
 		const FRotator Rotation = Controller->GetControlRotation();
@@ -135,9 +191,22 @@ void AClimbingSystemCharacter::HandleGroundMovementInput(const FInputActionValue
 }
 
 void AClimbingSystemCharacter::HandleClimbMovementInput(const FInputActionValue& Value) {
+	if(!bClimbInputActive) {
+		// off the wall the climb context only answers keys it took from the default one
+		if(ClimbActionShadows(ClimbMoveAction, MoveAction)) {
+			HandleGroundMovementInput(Value);
+		}
+		return;
+	}
+	if(inputRecorder.IsReplaying()) { return; }
+
 	// input is a Vector2D
 	const FVector2D MovementVector = Value.Get<FVector2D>();
+	inputRecorder.Record(EClimbInputEvent::ClimbMove, MovementVector);
+	ApplyClimbMovementInput(MovementVector);
+}
 
+void AClimbingSystemCharacter::ApplyClimbMovementInput(const FVector2D& MovementVector) {
 	const FVector ForwardDirection = FVector::CrossProduct(
 		-CustomMovementComponent->GetClimbableSurfaceNormal(),
 		GetActorRightVector());
@@ -153,9 +222,16 @@ void AClimbingSystemCharacter::HandleClimbMovementInput(const FInputActionValue&
 
 void AClimbingSystemCharacter::Look(const FInputActionValue& Value)
 {
+	if(inputRecorder.IsReplaying()) { return; }
+
 	// input is a Vector2D
 	FVector2D LookAxisVector = Value.Get<FVector2D>();
+	inputRecorder.Record(EClimbInputEvent::Look, LookAxisVector);
+	ApplyLookInput(LookAxisVector);
+}
 
+void AClimbingSystemCharacter::ApplyLookInput(const FVector2D& LookAxisVector)
+{
 	if (Controller != nullptr)
 	{
 		// add yaw and pitch input to controller
@@ -165,20 +241,124 @@ void AClimbingSystemCharacter::Look(const FInputActionValue& Value)
 }
 
 void AClimbingSystemCharacter::OnClimbActionStarted(const FInputActionValue& Value) {
+	if(inputRecorder.IsReplaying()) { return; }
+
+	inputRecorder.Record(EClimbInputEvent::ClimbAction, FVector2D::ZeroVector);
+	ApplyClimbAction();
+}
+
+void AClimbingSystemCharacter::ApplyClimbAction() {
 	if(!CustomMovementComponent) { return; }
 	CustomMovementComponent->ToggleClimbing(!CustomMovementComponent->IsClimbing());
 }
 
 void AClimbingSystemCharacter::OnPlayerEnterClimbState() {
-	AddInputMappingContext(ClimbMappingContext, 1);
+	bClimbInputActive = true;
 }
 
 void AClimbingSystemCharacter::OnPlayerExitClimbState() {
-	RemoveInputMappingContext(ClimbMappingContext);
+	bClimbInputActive = false;
 }
 
 void AClimbingSystemCharacter::OnClimbHopActionStarted(const FInputActionValue& Value) {
+	if(!bClimbInputActive) {
+		if(ClimbActionShadows(ClimbHopAction, JumpAction)) {
+			OnJumpActionTriggered(Value);
+		}
+		return;
+	}
+	if(inputRecorder.IsReplaying()) { return; }
+
+	inputRecorder.Record(EClimbInputEvent::ClimbHopAction, FVector2D::ZeroVector);
+	ApplyClimbHopAction();
+}
+
+void AClimbingSystemCharacter::OnClimbHopActionCompleted(const FInputActionValue& Value) {
+	// released on the wall or on the ground, either way a jump it started has to end
+	if(ClimbActionShadows(ClimbHopAction, JumpAction)) {
+		OnJumpActionCompleted(Value);
+	}
+}
+
+void AClimbingSystemCharacter::ApplyClimbHopAction() {
 	if(CustomMovementComponent) {
 		CustomMovementComponent->RequestHopping();
 	}
 }
+
+//////////////////////////////////////////////////////////////////////////
+// Input recording
+
+void AClimbingSystemCharacter::InitInputRecorder() {
+	bInputRecorderInitialized = true;
+
+	FString logPath;
+	if(FParse::Value(FCommandLine::Get(), TEXT("ClimbReplay="), logPath)) {
+		if(!inputRecorder.StartReplay(logPath)) {
+			UE_LOG(LogClimbing, Error, TEXT("ClimbInputRecorder: could not load %s"), *logPath);
+			return;
+		}
+
+		bExitAfterReplay = FParse::Param(FCommandLine::Get(), TEXT("ClimbReplayExit"));
+		TeleportTo(inputRecorder.GetStartTransform().GetLocation(), inputRecorder.GetStartTransform().Rotator());
+		if(Controller) {
+			Controller->SetControlRotation(inputRecorder.GetStartControlRotation());
+		}
+		return;
+	}
+
+	if(FParse::Value(FCommandLine::Get(), TEXT("ClimbRecord="), logPath)) {
+		float fixedDeltaTime = 1.f / 60.f;
+		FParse::Value(FCommandLine::Get(), TEXT("ClimbFixedDeltaTime="), fixedDeltaTime);
+		inputRecorder.StartRecording(logPath, fixedDeltaTime, GetActorTransform(), GetControlRotation());
+	}
+}
+
+void AClimbingSystemCharacter::TickInputRecorder() {
+	if(!bInputRecorderInitialized) {
+		// the controller is not always possessing us yet in BeginPlay
+		if(!IsLocallyControlled() || !IsPlayerControlled()) { return; }
+		InitInputRecorder();
+	}
+
+	if(inputRecorder.IsReplaying()) {
+		inputRecorder.DispatchFrameEvents([this](EClimbInputEvent event, const FVector2D& value) {
+			DispatchRecordedInput(event, value);
+		});
+	}
+
+	inputRecorder.AdvanceFrame(GetActorLocation(), GetActorRotation(), CustomMovementComponent && CustomMovementComponent->IsClimbing());
+
+	if(inputRecorder.IsReplayFinished()) {
+		inputRecorder.Stop();
+		if(bExitAfterReplay) {
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+void AClimbingSystemCharacter::DispatchRecordedInput(EClimbInputEvent event, const FVector2D& value) {
+	switch(event) {
+		case EClimbInputEvent::GroundMove:
+			ApplyGroundMovementInput(value);
+			break;
+		case EClimbInputEvent::ClimbMove:
+			ApplyClimbMovementInput(value);
+			break;
+		case EClimbInputEvent::Look:
+			ApplyLookInput(value);
+			break;
+		case EClimbInputEvent::ClimbAction:
+			ApplyClimbAction();
+			break;
+		case EClimbInputEvent::ClimbHopAction:
+			ApplyClimbHopAction();
+			break;
+		case EClimbInputEvent::Jump:
+			Jump();
+			break;
+		case EClimbInputEvent::StopJumping:
+			StopJumping();
+			break;
+	}
+}
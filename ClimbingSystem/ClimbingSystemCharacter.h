@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
+#include "Replay/ClimbInputRecorder.h"
 #include "ClimbingSystemCharacter.generated.h"
 
 class UCustomMovementComponent;
@@ -41,7 +42,16 @@ private:
 	void OnPlayerExitClimbState();
 #pragma region Input
 	void AddInputMappingContext(UInputMappingContext* contextToAdd, int32 InPriority);
-	void RemoveInputMappingContext(UInputMappingContext* contextToRemove);
+	void BuildClimbInputShadows();
+	bool ClimbActionShadows(const UInputAction* climbAction, const UInputAction* groundAction) const;
+
+	/**
+	 * Both mapping contexts stay registered for the whole session so entering and leaving climb never rebuilds the
+	 * player's mappings, climb actions check this flag instead. Keys bound in both contexts always reach the climb
+	 * action, which forwards to the ground action it shadows while the flag is off.
+	 */
+	bool bClimbInputActive = false;
+	TMap<const UInputAction*, TArray<const UInputAction*, TInlineAllocator<2>>> climbInputShadows;
 
 
 	/** MappingContext */
@@ -54,6 +64,8 @@ private:
 	/** Jump Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* JumpAction;
+	void OnJumpActionTriggered(const FInputActionValue& Value);
+	void OnJumpActionCompleted(const FInputActionValue& Value);
 
 	/** Move Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
@@ -64,6 +76,8 @@ private:
 
 	void HandleGroundMovementInput(const FInputActionValue& Value);
 	void HandleClimbMovementInput(const FInputActionValue& Value);
+	void ApplyGroundMovementInput(const FVector2D& MovementVector);
+	void ApplyClimbMovementInput(const FVector2D& MovementVector);
 
 	/** Look Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
@@ -71,16 +85,31 @@ private:
 
 	/** Called for looking input */
 	void Look(const FInputActionValue& Value);
+	void ApplyLookInput(const FVector2D& LookAxisVector);
 
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* ClimbAction;
 	void OnClimbActionStarted(const FInputActionValue& Value);
+	void ApplyClimbAction();
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* ClimbHopAction;
 	void OnClimbHopActionStarted(const FInputActionValue& Value);
+	void OnClimbHopActionCompleted(const FInputActionValue& Value);
+	void ApplyClimbHopAction();
+
+#pragma endregion
 
+#pragma region InputRecording
+	/** -ClimbRecord=<file> records this player's input, -ClimbReplay=<file> plays it back and -ClimbReplayExit quits once it ends */
+	void InitInputRecorder();
+	void TickInputRecorder();
+	void DispatchRecordedInput(EClimbInputEvent event, const FVector2D& value);
+
+	FClimbInputRecorder inputRecorder;
+	bool bInputRecorderInitialized = false;
+	bool bExitAfterReplay = false;
 #pragma endregion
 
 protected:
@@ -89,6 +118,8 @@ protected:
 	
 	// To add mapping context
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
 
 public:
 	/** Returns CameraBoom subobject **/
@@ -98,5 +129,8 @@ public:
 
 	FORCEINLINE UCustomMovementComponent* GetCustomMovementComponent() const { return CustomMovementComponent; } 
 	FORCEINLINE UMotionWarpingComponent* GetMotionWarpingComponent() const { return MotionWarpingComponent; }
+
+private:
+	friend struct FClimbBenchmarkAccess;
 };
 
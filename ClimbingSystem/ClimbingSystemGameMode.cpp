@@ -1,15 +1,91 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ClimbingSystemGameMode.h"
-#include "ClimbingSystemCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "ClimbingSystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/PlayerController.h"
+#include "IAnimationBudgetAllocator.h"
 
 AClimbingSystemGameMode::AClimbingSystemGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != NULL)
+	// set default pawn class to our Blueprinted character, only its path so constructing the game mode loads nothing
+	DefaultPawnSoftClass = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C")));
+}
+
+void AClimbingSystemGameMode::PreInitializeComponents()
+{
+	Super::PreInitializeComponents();
+
+	// the game mode is spawned before InitGame runs and before anyone can log in, the earliest point the pawn class can start streaming
+	if (!DefaultPawnSoftClass.IsNull() && !DefaultPawnSoftClass.Get())
+	{
+		DefaultPawnClassHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(DefaultPawnSoftClass.ToSoftObjectPath(),
+			FStreamableDelegate::CreateUObject(this, &AClimbingSystemGameMode::OnDefaultPawnClassLoaded),
+			FStreamableManager::AsyncLoadHighPriority, false, false, TEXT("DefaultPawnClass"));
+		if (DefaultPawnClassHandle.IsValid())
+		{
+			// a canceled load never completes, release the waiting players onto DefaultPawnClass instead
+			DefaultPawnClassHandle->BindCancelDelegate(FStreamableDelegate::CreateUObject(this, &AClimbingSystemGameMode::OnDefaultPawnClassLoaded));
+		}
+	}
+}
+
+void AClimbingSystemGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	if (IAnimationBudgetAllocator* BudgetAllocator = IAnimationBudgetAllocator::Get(GetWorld()))
+	{
+		if (bUseAnimationBudget)
+		{
+			FAnimationBudgetAllocatorParameters Parameters;
+			Parameters.BudgetInMs = AnimationBudgetMs;
+			BudgetAllocator->SetParameters(Parameters);
+		}
+		BudgetAllocator->SetEnabled(bUseAnimationBudget);
+	}
+}
+
+bool AClimbingSystemGameMode::IsDefaultPawnClassLoading() const
+{
+	return DefaultPawnClassHandle.IsValid() && !DefaultPawnClassHandle->HasLoadCompleted() && !DefaultPawnClassHandle->WasCanceled();
+}
+
+void AClimbingSystemGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// in standalone and PIE the first player logs in the same frame the stream starts, hold them instead of blocking on it
+	if (IsDefaultPawnClassLoading())
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		UE_LOG(LogClimbing, Log, TEXT("%s: %s not streamed in yet, %s spawns once it is"), *GetName(), *DefaultPawnSoftClass.ToString(), *GetNameSafe(NewPlayer));
+		PlayersAwaitingPawnClass.AddUnique(NewPlayer);
+		return;
 	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+void AClimbingSystemGameMode::OnDefaultPawnClassLoaded()
+{
+	if (!DefaultPawnSoftClass.Get())
+	{
+		UE_LOG(LogClimbing, Warning, TEXT("%s: could not load %s, spawning players as %s"), *GetName(), *DefaultPawnSoftClass.ToString(), *GetNameSafe(DefaultPawnClass));
+	}
+
+	TArray<TWeakObjectPtr<APlayerController>> PendingPlayers = MoveTemp(PlayersAwaitingPawnClass);
+	for (const TWeakObjectPtr<APlayerController>& Player : PendingPlayers)
+	{
+		// players that left while waiting are gone, the rest start exactly as they would have at login
+		if (Player.IsValid())
+		{
+			Super::HandleStartingNewPlayer_Implementation(Player.Get());
+		}
+	}
+}
+
+UClass* AClimbingSystemGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	// players are held in HandleStartingNewPlayer until the stream lands, so this only misses for a failed load
+	UClass* PawnClass = DefaultPawnSoftClass.Get();
+	return PawnClass ? PawnClass : Super::GetDefaultPawnClassForController_Implementation(InController);
 }
@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "ClimbingSystemGameMode.generated.h"
 
+struct FStreamableHandle;
+
 UCLASS(minimalapi)
 class AClimbingSystemGameMode : public AGameModeBase
 {
@@ -13,6 +15,34 @@ class AClimbingSystemGameMode : public AGameModeBase
 
 public:
 	AClimbingSystemGameMode();
+
+	virtual void PreInitializeComponents() override;
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+
+protected:
+	/** Throttle and interpolate the animation of far characters so all of it fits in AnimationBudgetMs */
+	UPROPERTY(EditDefaultsOnly, Category = "Animation Budget")
+	bool bUseAnimationBudget = true;
+
+	/** Game thread time per frame the budget allocator may spend ticking skeletal meshes */
+	UPROPERTY(EditDefaultsOnly, Category = "Animation Budget", meta = (EditCondition = "bUseAnimationBudget", ClampMin = "0.1", Units = "Milliseconds"))
+	float AnimationBudgetMs = 1.5f;
+
+	/** Pawn to spawn players as, streamed in while the map loads rather than with the game mode. Leave unset to use DefaultPawnClass */
+	UPROPERTY(EditDefaultsOnly, Category = Classes)
+	TSoftClassPtr<APawn> DefaultPawnSoftClass;
+
+private:
+	bool IsDefaultPawnClassLoading() const;
+	/** Starts the players that logged in while the pawn class was still streaming */
+	void OnDefaultPawnClassLoaded();
+
+	TSharedPtr<FStreamableHandle> DefaultPawnClassHandle;
+
+	/** Players held back from spawning until DefaultPawnSoftClass is in, in login order */
+	TArray<TWeakObjectPtr<APlayerController>> PlayersAwaitingPawnClass;
 };
 
 
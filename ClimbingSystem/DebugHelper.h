@@ -1,12 +1,16 @@
 #pragma once
 
+#include "Debug/ClimbLog.h"
 
 namespace Debug {
-	static void Print(const FString& msg, const FColor& color = FColor::MakeRandomColor(), int32 inKey = -1) {
+	/** On-screen print for local debugging, the message always goes to the climb log ring as well */
+	inline void Print(const FString& msg, const FColor& color = FColor::Cyan, int32 inKey = -1) {
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
 		if(GEngine) {
 			GEngine->AddOnScreenDebugMessage(inKey, 6.f, color, msg);
 		}
+#endif
 
-		UE_LOG(LogTemp, Warning, TEXT("%s"), *msg);
+		CLIMB_LOG(Log, TEXT("%s"), *msg);
 	}
-}
\ No newline at end of file
+}
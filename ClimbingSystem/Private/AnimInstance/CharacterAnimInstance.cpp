@@ -4,7 +4,6 @@
 #include "AnimInstance/CharacterAnimInstance.h"
 #include "ClimbingSystem/ClimbingSystemCharacter.h"
 #include "Components/CustomMovementComponent.h"
-#include "Kismet/KismetMathLibrary.h"
 
 void UCharacterAnimInstance::NativeInitializeAnimation() {
 	Super::NativeInitializeAnimation();
@@ -19,38 +18,55 @@ void UCharacterAnimInstance::NativeInitializeAnimation() {
 void UCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds) {
 	Super::NativeUpdateAnimation(DeltaSeconds);
 
-	if(!climbingSystemChar || !customMovementComp) { return; }
+	// the component rewrites its snapshot while the game thread ticks, so take our own copy before the worker runs
+	if(customMovementComp) {
+		animSnapshot = customMovementComp->GetAnimSnapshot();
+	}
+}
+
+void UCharacterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds) {
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
 
-	GetGroundSpeed();
-	GetAirSpeed();
-	GetIsFalling();
-	GetShouldMove();
-	GetIsClimbing();
-	GetClimbVelocity();
+	if(!customMovementComp) { return; }
+
+	GetGroundSpeed(animSnapshot);
+	GetAirSpeed(animSnapshot);
+	GetIsFalling(animSnapshot);
+	GetShouldMove(animSnapshot);
+	GetIsClimbing(animSnapshot);
+	GetClimbVelocity(animSnapshot);
+	GetLimbIK(animSnapshot);
 }
 
-void UCharacterAnimInstance::GetGroundSpeed() {
-	groundSpeed = UKismetMathLibrary::VSizeXY(climbingSystemChar->GetVelocity());
+void UCharacterAnimInstance::GetGroundSpeed(const FClimbAnimSnapshot& snapshot) {
+	groundSpeed = snapshot.Velocity.Size2D();
 }
 
-void UCharacterAnimInstance::GetAirSpeed() {
-	airSpeed = climbingSystemChar->GetVelocity().Z;
+void UCharacterAnimInstance::GetAirSpeed(const FClimbAnimSnapshot& snapshot) {
+	airSpeed = snapshot.Velocity.Z;
 }
 
-void UCharacterAnimInstance::GetShouldMove() {
-	bShouldMove = customMovementComp->GetCurrentAcceleration().Size() > 0 &&
+void UCharacterAnimInstance::GetShouldMove(const FClimbAnimSnapshot& snapshot) {
+	bShouldMove = snapshot.bHasAcceleration &&
 					groundSpeed > 5.f &&
 					!bIsFalling;
 }
 
-void UCharacterAnimInstance::GetIsFalling() {
-	bIsFalling = customMovementComp->IsFalling();
+void UCharacterAnimInstance::GetIsFalling(const FClimbAnimSnapshot& snapshot) {
+	bIsFalling = snapshot.bIsFalling;
+}
+
+void UCharacterAnimInstance::GetIsClimbing(const FClimbAnimSnapshot& snapshot) {
+	bIsClimbing = snapshot.bIsClimbing;
 }
 
-void UCharacterAnimInstance::GetIsClimbing() {
-	bIsClimbing = customMovementComp->IsClimbing();
+void UCharacterAnimInstance::GetClimbVelocity(const FClimbAnimSnapshot& snapshot) {
+	climbVelocity = snapshot.UnrotatedClimbVelocity;
 }
 
-void UCharacterAnimInstance::GetClimbVelocity() {
-	climbVelocity = customMovementComp->getUnrotatedClimbVelocity();
+void UCharacterAnimInstance::GetLimbIK(const FClimbAnimSnapshot& snapshot) {
+	leftHandIK = snapshot.LeftHandIK;
+	rightHandIK = snapshot.RightHandIK;
+	leftFootIK = snapshot.LeftFootIK;
+	rightFootIK = snapshot.RightFootIK;
 }
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "Components/CustomMovementComponent.h"
+#include "Climbing/ClimbQuerySubsystem.h"
+
+/** The only way the climb benchmark reaches past the public API, so the gameplay classes do not depend on the commandlet */
+struct FClimbBenchmarkAccess {
+	static FHitResult VaultLineTrace(UCustomMovementComponent& movement, const FVector& start, const FVector& end) {
+		return movement.DoLineTraceSingleByObject(start, end, EClimbDebugCategory::Vault);
+	}
+
+	static bool CanStartVaulting(UCustomMovementComponent& movement, FVector& outVaultStartPosition, FVector& outVaultLandPosition) {
+		return movement.CanStartVaulting(outVaultStartPosition, outVaultLandPosition);
+	}
+
+	/** Keeps the climber at full LOD so it queues its queries every batch */
+	static void ForceFullClimbLOD(UCustomMovementComponent& movement) {
+		movement.bEnableClimbLOD = false;
+		movement.SetClimbLOD(EClimbLOD::Full);
+	}
+
+	static void UseQuerySubsystem(UCustomMovementComponent& movement, UClimbQuerySubsystem& subsystem) {
+		movement.bUseClimbQuerySubsystem = true;
+		movement.querySubsystem = &subsystem;
+		subsystem.RegisterClimber(&movement);
+	}
+
+	static UInputMappingContext* GetDefaultMappingContext(const AClimbingSystemCharacter& character) {
+		return character.DefaultMappingContext;
+	}
+
+	static UInputMappingContext* GetClimbMappingContext(const AClimbingSystemCharacter& character) {
+		return character.ClimbMappingContext;
+	}
+
+	static void SetClimbInputMode(AClimbingSystemCharacter& character, bool bClimbing) {
+		if(bClimbing) {
+			character.OnPlayerEnterClimbState();
+		} else {
+			character.OnPlayerExitClimbState();
+		}
+	}
+};
@@ -0,0 +1,482 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Benchmark/ClimbBenchmarkCommandlet.h"
+#include "Benchmark/ClimbBenchmarkAccess.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "Components/CustomMovementComponent.h"
+#include "Climbing/ClimbMath.h"
+#include "Climbing/ClimbQuerySubsystem.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+#include "EnhancedInputSubsystems.h"
+#include "EnhancedPlayerInput.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace {
+	constexpr float LaneSpacing = 600.f;
+	constexpr int32 ScriptPeriodFrames = 600;
+	// parks the climber so the first probe of either vault detector lands on the vault lane's obstacle
+	constexpr float VaultProbeStandoff = 200.f;
+	constexpr float VaultAgreementTolerance = 1.f;
+	// capsule centre of a climber hanging on a wall lane's face, and the height of the lowest row of the query batch grid
+	constexpr float WallHangX = 355.f;
+	constexpr float QueryBatchBaseHeight = 150.f;
+	const TCHAR* DefaultCharacterClass = TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C");
+
+	enum class ELaneType : uint8 {
+		Wall,
+		Overhang,
+		Vault,
+		Num
+	};
+
+	ELaneType GetLaneType(int32 laneIndex) {
+		return static_cast<ELaneType>(laneIndex % static_cast<int32>(ELaneType::Num));
+	}
+
+	void SpawnBlock(UWorld* world, UStaticMesh* cube, const FVector& center, const FVector& sizeInCm) {
+		// the engine cube is 100cm on a side
+		const FTransform transform(FRotator::ZeroRotator, center, sizeInCm / 100.f);
+		auto* block = world->SpawnActorDeferred<AStaticMeshActor>(AStaticMeshActor::StaticClass(), transform);
+		if(!block) { return; }
+
+		block->GetStaticMeshComponent()->SetStaticMesh(cube);
+		block->GetStaticMeshComponent()->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		block->FinishSpawning(transform);
+	}
+}
+
+UClimbBenchmarkCommandlet::UClimbBenchmarkCommandlet() {
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+FTransform UClimbBenchmarkCommandlet::GetLaneStart(int32 laneIndex) const {
+	return FTransform(FRotator::ZeroRotator, FVector(0.f, laneIndex * LaneSpacing, 100.f));
+}
+
+void UClimbBenchmarkCommandlet::BuildCourse(UWorld* world, int32 numLanes) const {
+	auto* cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if(!cube) { return; }
+
+	const auto courseWidth = numLanes * LaneSpacing;
+	SpawnBlock(world, cube, FVector(500.f, courseWidth * 0.5f - LaneSpacing * 0.5f, -50.f), FVector(3000.f, courseWidth + LaneSpacing, 100.f));
+
+	for(auto lane = 0; lane < numLanes; ++lane) {
+		const auto laneY = lane * LaneSpacing;
+		switch(GetLaneType(lane)) {
+			case ELaneType::Wall:
+				SpawnBlock(world, cube, FVector(425.f, laneY, 400.f), FVector(50.f, 400.f, 800.f));
+				break;
+			case ELaneType::Overhang:
+				SpawnBlock(world, cube, FVector(425.f, laneY, 400.f), FVector(50.f, 400.f, 800.f));
+				SpawnBlock(world, cube, FVector(350.f, laneY, 820.f), FVector(200.f, 400.f, 40.f));
+				break;
+			case ELaneType::Vault:
+				// taller than the capsule centre, where the first vault probe stops, so both detectors land on its top
+				SpawnBlock(world, cube, FVector(350.f, laneY, 60.f), FVector(100.f, 200.f, 120.f));
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void UClimbBenchmarkCommandlet::DriveClimber(AClimbingSystemCharacter* climber, int32 climberIndex, int32 frame) const {
+	auto* movement = climber->GetCustomMovementComponent();
+	if(!movement) { return; }
+
+	// stagger climbers so the course always has a mix of approaches, climbs, hops and vaults in flight
+	const auto phase = (frame + climberIndex * 7) % ScriptPeriodFrames;
+	if(phase == 0) {
+		if(movement->IsClimbing()) {
+			movement->ToggleClimbing(false);
+		}
+		const auto laneStart = GetLaneStart(climberIndex);
+		climber->TeleportTo(laneStart.GetLocation(), laneStart.Rotator());
+		return;
+	}
+
+	if(!movement->IsClimbing()) {
+		climber->AddMovementInput(climber->GetActorForwardVector(), 1.f);
+		if(phase % 30 == 15) {
+			movement->ToggleClimbing(true);
+		}
+		return;
+	}
+
+	const auto climbUp = ClimbMath::ComputeClimbInputDirection(
+		FVector2D(0.f, 1.f),
+		movement->GetClimbableSurfaceNormal(),
+		climber->GetActorRightVector(),
+		climber->GetActorUpVector());
+	climber->AddMovementInput(climbUp, 1.f);
+
+	if(phase % 90 == 45) {
+		movement->RequestHopping();
+	}
+}
+
+bool UClimbBenchmarkCommandlet::LegacyCanStartVaulting(UCustomMovementComponent& movement, FVector& outVaultStartPosition, FVector& outVaultLandPosition) {
+	if(movement.IsFalling()) { return false; }
+
+	outVaultStartPosition = FVector::ZeroVector;
+	outVaultLandPosition = FVector::ZeroVector;
+
+	const auto* updatedComponent = movement.UpdatedComponent.Get();
+	auto componentLocation = updatedComponent->GetComponentLocation();
+	auto componentForward = updatedComponent->GetForwardVector();
+	auto upVector = updatedComponent->GetUpVector();
+	auto downVector = -updatedComponent->GetUpVector();
+	auto forwardAmount = 150.f;
+
+	for(auto i = 0; i < 5; ++i) {
+		auto newForward = forwardAmount;
+		if(i != 0) { newForward -= 20; }
+		auto start = componentLocation + upVector * 100.f + componentForward * newForward * (i + 1);
+		auto end = start + downVector * 100.f * (i + 1);
+
+		auto hit = FClimbBenchmarkAccess::VaultLineTrace(movement, start, end);
+
+		if(i == 0 && hit.bBlockingHit) {
+			outVaultStartPosition = hit.ImpactPoint;
+		}
+
+		if(i == 4 && hit.bBlockingHit) {
+			outVaultLandPosition = hit.ImpactPoint;
+		}
+	}
+
+	return outVaultStartPosition != FVector::ZeroVector && outVaultLandPosition != FVector::ZeroVector;
+}
+
+void UClimbBenchmarkCommandlet::MeasureVaultDetectors(const TArray<AClimbingSystemCharacter*>& climbers, int32 numProbes, FJsonObject& report) const {
+	TArray<UCustomMovementComponent*> vaulters;
+	for(auto i = 0; i < climbers.Num(); ++i) {
+		if(GetLaneType(i) != ELaneType::Vault) { continue; }
+
+		auto* climber = climbers[i];
+		auto* movement = climber->GetCustomMovementComponent();
+		movement->StopMovementImmediately();
+		movement->SetMovementMode(MOVE_Walking);
+		const auto laneStart = GetLaneStart(i);
+		climber->TeleportTo(laneStart.GetLocation() + FVector(VaultProbeStandoff, 0.f, 0.f), laneStart.Rotator());
+		vaulters.Add(movement);
+	}
+	if(vaulters.IsEmpty()) { return; }
+
+	struct FDetectorRun {
+		uint64 Cycles = 0;
+		uint32 NumQueries = 0;
+		int32 NumFound = 0;
+	};
+	auto measure = [&](TFunctionRef<bool(UCustomMovementComponent&, FVector&, FVector&)> detector) {
+		FDetectorRun run;
+		for(auto* movement : vaulters) {
+			movement->ResetPerfCounters();
+		}
+
+		FVector vaultStart, vaultLand;
+		const auto startCycles = FPlatformTime::Cycles64();
+		for(auto probe = 0; probe < numProbes; ++probe) {
+			for(auto* movement : vaulters) {
+				run.NumFound += detector(*movement, vaultStart, vaultLand) ? 1 : 0;
+			}
+		}
+		run.Cycles = FPlatformTime::Cycles64() - startCycles;
+
+		for(auto* movement : vaulters) {
+			run.NumQueries += movement->GetPerfCounters().NumSceneQueries + movement->GetPerfCounters().NumIndexQueries;
+		}
+		return run;
+	};
+
+	const auto legacy = measure([](UCustomMovementComponent& movement, FVector& outStart, FVector& outLand) {
+		return LegacyCanStartVaulting(movement, outStart, outLand);
+	});
+	const auto detector = measure([](UCustomMovementComponent& movement, FVector& outStart, FVector& outLand) {
+		return FClimbBenchmarkAccess::CanStartVaulting(movement, outStart, outLand);
+	});
+
+	// both must pick the same warp targets from the parked pose, otherwise the timing compares different work
+	auto numAgreeing = 0;
+	for(auto* movement : vaulters) {
+		FVector legacyStart, legacyLand, detectorStart, detectorLand;
+		const auto bLegacyFound = LegacyCanStartVaulting(*movement, legacyStart, legacyLand);
+		const auto bDetectorFound = FClimbBenchmarkAccess::CanStartVaulting(*movement, detectorStart, detectorLand);
+		if(bLegacyFound == bDetectorFound &&
+		   (!bLegacyFound || (legacyStart.Equals(detectorStart, VaultAgreementTolerance) && legacyLand.Equals(detectorLand, VaultAgreementTolerance)))) {
+			++numAgreeing;
+		}
+	}
+
+	const auto numCalls = static_cast<double>(numProbes) * vaulters.Num();
+	auto vault = MakeShared<FJsonObject>();
+	vault->SetNumberField(TEXT("vaulters"), vaulters.Num());
+	vault->SetNumberField(TEXT("probesPerVaulter"), numProbes);
+	vault->SetNumberField(TEXT("legacyQueriesPerProbe"), legacy.NumQueries / numCalls);
+	vault->SetNumberField(TEXT("detectorQueriesPerProbe"), detector.NumQueries / numCalls);
+	vault->SetNumberField(TEXT("legacyAvgProbeUs"), FPlatformTime::ToMilliseconds64(legacy.Cycles) * 1000.0 / numCalls);
+	vault->SetNumberField(TEXT("detectorAvgProbeUs"), FPlatformTime::ToMilliseconds64(detector.Cycles) * 1000.0 / numCalls);
+	vault->SetNumberField(TEXT("legacyFoundFraction"), legacy.NumFound / numCalls);
+	vault->SetNumberField(TEXT("detectorFoundFraction"), detector.NumFound / numCalls);
+	vault->SetNumberField(TEXT("agreeingVaulters"), numAgreeing);
+	report.SetObjectField(TEXT("vault"), vault);
+}
+
+void UClimbBenchmarkCommandlet::MeasureInputModeSwitches(AClimbingSystemCharacter& climber, int32 numSwitches, FJsonObject& report) const {
+	auto* defaultContext = FClimbBenchmarkAccess::GetDefaultMappingContext(climber);
+	auto* climbContext = FClimbBenchmarkAccess::GetClimbMappingContext(climber);
+	if(!defaultContext || !climbContext) {
+		UE_LOG(LogClimbing, Warning, TEXT("ClimbBenchmark: %s has no mapping contexts, skipping the input switch measurement"), *GetNameSafe(climber.GetClass()));
+		return;
+	}
+
+	// without a game instance the local player never creates its subsystems, wire one to a bare player and controller
+	// by hand, which is all the Enhanced Input mapping rebuild needs to run headless
+	auto* localPlayer = NewObject<ULocalPlayer>(GEngine);
+	auto* controller = climber.GetWorld()->SpawnActor<APlayerController>();
+	controller->PlayerInput = NewObject<UEnhancedPlayerInput>(controller);
+	localPlayer->PlayerController = controller;
+	auto* subsystem = NewObject<UEnhancedInputLocalPlayerSubsystem>(localPlayer);
+
+	// rebuild on the switch rather than on the next input tick, so the cost the old switch paid lands in the timed loop
+	FModifyContextOptions immediate;
+	immediate.bForceImmediately = true;
+	subsystem->AddMappingContext(defaultContext, 0, immediate);
+
+	auto startCycles = FPlatformTime::Cycles64();
+	for(auto i = 0; i < numSwitches; ++i) {
+		if(i % 2 == 0) {
+			subsystem->AddMappingContext(climbContext, 1, immediate);
+		} else {
+			subsystem->RemoveMappingContext(climbContext, immediate);
+		}
+	}
+	const auto rebuildCycles = FPlatformTime::Cycles64() - startCycles;
+
+	subsystem->AddMappingContext(climbContext, 1, immediate);
+	startCycles = FPlatformTime::Cycles64();
+	for(auto i = 0; i < numSwitches; ++i) {
+		FClimbBenchmarkAccess::SetClimbInputMode(climber, i % 2 == 0);
+	}
+	const auto modeFlagCycles = FPlatformTime::Cycles64() - startCycles;
+	FClimbBenchmarkAccess::SetClimbInputMode(climber, false);
+	controller->Destroy();
+
+	auto inputSwitch = MakeShared<FJsonObject>();
+	inputSwitch->SetNumberField(TEXT("switches"), numSwitches);
+	inputSwitch->SetNumberField(TEXT("contextRebuildAvgSwitchUs"), FPlatformTime::ToMilliseconds64(rebuildCycles) * 1000.0 / numSwitches);
+	inputSwitch->SetNumberField(TEXT("modeFlagAvgSwitchUs"), FPlatformTime::ToMilliseconds64(modeFlagCycles) * 1000.0 / numSwitches);
+	report.SetObjectField(TEXT("inputSwitch"), inputSwitch);
+}
+
+void UClimbBenchmarkCommandlet::MeasureQueryBatch(const TArray<AClimbingSystemCharacter*>& climbers, int32 numBatches, float spacing, FJsonObject& report) const {
+	auto* subsystem = climbers[0]->GetWorld()->GetSubsystem<UClimbQuerySubsystem>();
+	if(!subsystem) { return; }
+
+	// a square grid on lane 0's wall, so neighbours are spacing apart and a spacing of 0 stacks everyone on one spot
+	const auto numColumns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(climbers.Num())));
+	const auto laneStart = GetLaneStart(0);
+	for(auto i = 0; i < climbers.Num(); ++i) {
+		const auto column = i % numColumns;
+		const auto row = i / numColumns;
+		auto* movement = climbers[i]->GetCustomMovementComponent();
+		movement->StopMovementImmediately();
+		movement->SetMovementMode(MOVE_Walking);
+		climbers[i]->TeleportTo(FVector(WallHangX, laneStart.GetLocation().Y + (column - (numColumns - 1) * 0.5f) * spacing, QueryBatchBaseHeight + row * spacing), laneStart.Rotator());
+
+		FClimbBenchmarkAccess::ForceFullClimbLOD(*movement);
+		FClimbBenchmarkAccess::UseQuerySubsystem(*movement, *subsystem);
+		movement->EnterClimbImmediately(FVector::ZeroVector);
+	}
+
+	struct FBatchRun {
+		uint64 Cycles = 0;
+		int64 NumRequests = 0;
+		int64 NumUniqueQueries = 0;
+	};
+	auto measure = [&](bool bSingleThread) {
+		FBatchRun run;
+		subsystem->SetForceSingleThread(bSingleThread);
+		for(auto batch = 0; batch < numBatches; ++batch) {
+			const auto startCycles = FPlatformTime::Cycles64();
+			subsystem->RunBatch();
+			run.Cycles += FPlatformTime::Cycles64() - startCycles;
+			run.NumRequests += subsystem->GetNumRequests();
+			run.NumUniqueQueries += subsystem->GetNumUniqueQueries();
+		}
+		subsystem->SetForceSingleThread(false);
+		return run;
+	};
+
+	const auto serial = measure(true);
+	const auto parallel = measure(false);
+
+	for(auto* climber : climbers) {
+		subsystem->UnregisterClimber(climber->GetCustomMovementComponent());
+	}
+
+	// the same counts feed STAT_Climb_BatchedQueryRequests and STAT_Climb_BatchedUniqueQueries
+	const auto serialMs = FPlatformTime::ToMilliseconds64(serial.Cycles) / numBatches;
+	const auto parallelMs = FPlatformTime::ToMilliseconds64(parallel.Cycles) / numBatches;
+	auto queryBatch = MakeShared<FJsonObject>();
+	queryBatch->SetNumberField(TEXT("climbers"), climbers.Num());
+	queryBatch->SetNumberField(TEXT("spacing"), spacing);
+	queryBatch->SetNumberField(TEXT("batches"), numBatches);
+	queryBatch->SetNumberField(TEXT("workerThreads"), FTaskGraphInterface::Get().GetNumWorkerThreads());
+	queryBatch->SetNumberField(TEXT("requestsPerBatch"), static_cast<double>(parallel.NumRequests) / numBatches);
+	queryBatch->SetNumberField(TEXT("uniqueQueriesPerBatch"), static_cast<double>(parallel.NumUniqueQueries) / numBatches);
+	queryBatch->SetNumberField(TEXT("duplicateFraction"), parallel.NumRequests > 0 ? 1.0 - static_cast<double>(parallel.NumUniqueQueries) / parallel.NumRequests : 0.0);
+	queryBatch->SetNumberField(TEXT("serialBatchMs"), serialMs);
+	queryBatch->SetNumberField(TEXT("parallelBatchMs"), parallelMs);
+	queryBatch->SetNumberField(TEXT("parallelSpeedup"), parallelMs > 0.0 ? serialMs / parallelMs : 0.0);
+	report.SetObjectField(TEXT("queryBatch"), queryBatch);
+}
+
+int32 UClimbBenchmarkCommandlet::Main(const FString& Params) {
+	int32 numClimbers = 32;
+	int32 numFrames = 1800;
+	float fixedDeltaTime = 1.f / 60.f;
+	float maxPhysClimbMs = 0.f;
+	int32 numVaultProbes = 1000;
+	int32 numInputSwitches = 1000;
+	int32 numQueryBatches = 300;
+	float queryBatchSpacing = 100.f;
+	FString characterClassPath = DefaultCharacterClass;
+	FString outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks/ClimbBenchmark.json");
+
+	FParse::Value(*Params, TEXT("Climbers="), numClimbers);
+	FParse::Value(*Params, TEXT("Frames="), numFrames);
+	FParse::Value(*Params, TEXT("FixedDeltaTime="), fixedDeltaTime);
+	FParse::Value(*Params, TEXT("MaxPhysClimbMs="), maxPhysClimbMs);
+	FParse::Value(*Params, TEXT("VaultProbes="), numVaultProbes);
+	FParse::Value(*Params, TEXT("InputSwitches="), numInputSwitches);
+	FParse::Value(*Params, TEXT("QueryBatches="), numQueryBatches);
+	FParse::Value(*Params, TEXT("QueryBatchSpacing="), queryBatchSpacing);
+	FParse::Value(*Params, TEXT("CharacterClass="), characterClassPath);
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	numClimbers = FMath::Max(numClimbers, 1);
+	numFrames = FMath::Max(numFrames, 1);
+
+	auto* characterClass = LoadClass<AClimbingSystemCharacter>(nullptr, *characterClassPath);
+	if(!characterClass) {
+		UE_LOG(LogClimbing, Error, TEXT("ClimbBenchmark: could not load character class %s"), *characterClassPath);
+		return 1;
+	}
+
+	auto* world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ClimbBenchmark"));
+	auto& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+	world->InitializeActorsForPlay(FURL());
+
+	BuildCourse(world, numClimbers);
+
+	TArray<AClimbingSystemCharacter*> climbers;
+	climbers.Reserve(numClimbers);
+	for(auto i = 0; i < numClimbers; ++i) {
+		FActorSpawnParameters spawnParams;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		auto* climber = world->SpawnActor<AClimbingSystemCharacter>(characterClass, GetLaneStart(i), spawnParams);
+		if(!climber) { continue; }
+
+		// nothing renders under -nullrhi, montages still have to advance for climb transitions to fire
+		climber->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		climber->GetCustomMovementComponent()->bRunPhysicsWithNoController = true;
+		climbers.Add(climber);
+	}
+
+	world->GetWorldSettings()->NotifyBeginPlay();
+	world->GetWorldSettings()->NotifyMatchStarted();
+
+	for(auto* climber : climbers) {
+		climber->GetCustomMovementComponent()->ResetPerfCounters();
+	}
+
+	const auto memoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	TArray<double> frameTimesMs;
+	frameTimesMs.Reserve(numFrames);
+	auto numClimbingSamples = 0;
+
+	for(auto frame = 0; frame < numFrames; ++frame) {
+		for(auto i = 0; i < climbers.Num(); ++i) {
+			DriveClimber(climbers[i], i, frame);
+			numClimbingSamples += climbers[i]->GetCustomMovementComponent()->IsClimbing() ? 1 : 0;
+		}
+
+		const auto frameStart = FPlatformTime::Seconds();
+		world->Tick(LEVELTICK_All, fixedDeltaTime);
+		frameTimesMs.Add((FPlatformTime::Seconds() - frameStart) * 1000.0);
+		++GFrameCounter;
+	}
+
+	const auto memoryAfter = FPlatformMemory::GetStats().UsedPhysical;
+
+	FClimbPerfCounters totals;
+	for(auto* climber : climbers) {
+		totals += climber->GetCustomMovementComponent()->GetPerfCounters();
+	}
+
+	frameTimesMs.Sort();
+	auto totalFrameMs = 0.0;
+	for(const auto frameMs : frameTimesMs) {
+		totalFrameMs += frameMs;
+	}
+
+	const auto physClimbTicks = FMath::Max<uint32>(totals.NumPhysClimbTicks, 1);
+	const auto avgPhysClimbMs = FPlatformTime::ToMilliseconds64(totals.PhysClimbCycles) / physClimbTicks;
+
+	auto report = MakeShared<FJsonObject>();
+	report->SetNumberField(TEXT("climbers"), climbers.Num());
+	report->SetNumberField(TEXT("frames"), numFrames);
+	report->SetNumberField(TEXT("fixedDeltaTime"), fixedDeltaTime);
+	report->SetBoolField(TEXT("perfCountersEnabled"), CLIMB_PERF_COUNTERS != 0);
+	report->SetNumberField(TEXT("avgFrameMs"), totalFrameMs / numFrames);
+	report->SetNumberField(TEXT("p95FrameMs"), frameTimesMs[FMath::Min(numFrames - 1, FMath::FloorToInt(numFrames * 0.95f))]);
+	report->SetNumberField(TEXT("physClimbTicks"), totals.NumPhysClimbTicks);
+	report->SetNumberField(TEXT("avgPhysClimbMs"), avgPhysClimbMs);
+	report->SetNumberField(TEXT("sceneQueriesPerClimbTick"), static_cast<double>(totals.NumSceneQueries) / physClimbTicks);
+	report->SetNumberField(TEXT("indexQueriesPerClimbTick"), static_cast<double>(totals.NumIndexQueries) / physClimbTicks);
+	report->SetNumberField(TEXT("hitsPerClimbTick"), static_cast<double>(totals.NumHits) / physClimbTicks);
+	report->SetNumberField(TEXT("climbingFraction"), static_cast<double>(numClimbingSamples) / (numFrames * FMath::Max(climbers.Num(), 1)));
+	report->SetNumberField(TEXT("usedPhysicalDeltaBytes"), static_cast<double>(memoryAfter) - static_cast<double>(memoryBefore));
+	if(numVaultProbes > 0) {
+		MeasureVaultDetectors(climbers, numVaultProbes, *report);
+	}
+	if(numInputSwitches > 0 && !climbers.IsEmpty()) {
+		MeasureInputModeSwitches(*climbers[0], numInputSwitches, *report);
+	}
+	if(numQueryBatches > 0 && !climbers.IsEmpty()) {
+		MeasureQueryBatch(climbers, numQueryBatches, FMath::Max(queryBatchSpacing, 0.f), *report);
+	}
+
+	FString reportJson;
+	FJsonSerializer::Serialize(report, TJsonWriterFactory<>::Create(&reportJson));
+	FFileHelper::SaveStringToFile(reportJson, *outputPath);
+	UE_LOG(LogClimbing, Display, TEXT("ClimbBenchmark: %s"), *reportJson);
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	if(maxPhysClimbMs > 0.f && avgPhysClimbMs > maxPhysClimbMs) {
+		UE_LOG(LogClimbing, Error, TEXT("ClimbBenchmark: average PhysClimb %.4fms is over the %.4fms budget"), avgPhysClimbMs, maxPhysClimbMs);
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbAIController.h"
+#include "Climbing/ClimbPathFollowingComponent.h"
+
+AClimbAIController::AClimbAIController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UClimbPathFollowingComponent>(TEXT("PathFollowingComponent"))) {
+}
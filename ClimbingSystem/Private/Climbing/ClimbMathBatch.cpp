@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbMathBatch.h"
+#include "Climbing/ClimbMath.h"
+#include "Math/VectorRegister.h"
+
+namespace ClimbMath {
+	void FClimbSurfaceBatch::Reset(int32 inNumClimbers) {
+		numClimbers = inNumClimbers;
+		numLanes = Align(inNumClimbers, LaneWidth);
+
+		for(auto* lanes : { &ToSurfaceX, &ToSurfaceY, &ToSurfaceZ, &ForwardX, &ForwardY, &ForwardZ, &NormalX, &NormalY, &NormalZ, &SnapX, &SnapY, &SnapZ }) {
+			// clear the whole array, not just growth, so padding and lanes left unset are zero from the last chunk too
+			lanes->SetNumUninitialized(numLanes, false);
+			FMemory::Memzero(lanes->GetData(), numLanes * sizeof(float));
+		}
+		StopMasks.SetNumZeroed(numLanes / LaneWidth, false);
+	}
+
+	void FClimbSurfaceBatch::ComputeShouldStop() {
+		const auto minDot = VectorSetFloat1(MinStopClimbingDot);
+		for(auto i = 0; i < numLanes; i += LaneWidth) {
+			const auto normalZ = VectorLoadAligned(&NormalZ[i]);
+			StopMasks[i / LaneWidth] = static_cast<uint8>(VectorMaskBits(VectorCompareGE(normalZ, minDot)));
+		}
+	}
+
+	void FClimbSurfaceBatch::ComputeSnapDeltas(float deltaTime, float snapSpeed) {
+		// -normal * |toSurface . forward| * dt * speed, the forward vector comes from a quat so it is already unit length
+		const auto negativeScale = VectorSetFloat1(-deltaTime * snapSpeed);
+		for(auto i = 0; i < numLanes; i += LaneWidth) {
+			auto dot = VectorMultiply(VectorLoadAligned(&ToSurfaceX[i]), VectorLoadAligned(&ForwardX[i]));
+			dot = VectorMultiplyAdd(VectorLoadAligned(&ToSurfaceY[i]), VectorLoadAligned(&ForwardY[i]), dot);
+			dot = VectorMultiplyAdd(VectorLoadAligned(&ToSurfaceZ[i]), VectorLoadAligned(&ForwardZ[i]), dot);
+			const auto scale = VectorMultiply(VectorAbs(dot), negativeScale);
+
+			VectorStoreAligned(VectorMultiply(VectorLoadAligned(&NormalX[i]), scale), &SnapX[i]);
+			VectorStoreAligned(VectorMultiply(VectorLoadAligned(&NormalY[i]), scale), &SnapY[i]);
+			VectorStoreAligned(VectorMultiply(VectorLoadAligned(&NormalZ[i]), scale), &SnapZ[i]);
+		}
+	}
+}
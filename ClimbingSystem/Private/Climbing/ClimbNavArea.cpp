@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbNavArea.h"
+
+UClimbNavArea::UClimbNavArea() {
+	// climbing covers ground at a fifth of the walk speed, MaxClimbSpeed 100 against MaxWalkSpeed 500
+	DefaultCost = 5.f;
+	DrawColor = FColor(255, 140, 0);
+}
@@ -0,0 +1,502 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbNavGraph.h"
+#include "Climbing/ClimbNavArea.h"
+#include "Climbing/ClimbSurfaceIndex.h"
+#include "Climbing/ClimbingStats.h"
+#include "Components/CustomMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include "AI/Navigation/NavigationRelevantData.h"
+#include "AI/NavigationSystemHelpers.h"
+#include "NavigationSystem.h"
+#include "Algo/Reverse.h"
+#include "EngineUtils.h"
+
+namespace {
+	// same face of the wall, hops and climbs do not wrap around corners sharper than this
+	constexpr float ClimbNavSameFaceMinDot = 0.7f;
+
+	FClimbNavStep MakeStep(EClimbNavAction action, const FClimbNavNode& node) {
+		FClimbNavStep step;
+		step.Action = action;
+		step.Location = node.Location;
+		step.Normal = node.Type == EClimbNavNodeType::Wall ? FVector(node.Normal) : FVector::ZeroVector;
+		return step;
+	}
+}
+
+struct AClimbNavGraph::FSearchScratch {
+	TArray<FSearchNode> Nodes;
+	uint32 Generation = 0;
+};
+
+AClimbNavGraph::AClimbNavGraph() {
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	ClimberClass = AClimbingSystemCharacter::StaticClass();
+}
+
+void AClimbNavGraph::PostLoad() {
+	Super::PostLoad();
+	BuildNodeGrid();
+}
+
+void AClimbNavGraph::BuildNodeGrid() {
+	nodeGrid.Reset();
+	for(auto i = 0; i < Nodes.Num(); ++i) {
+		const auto cell = FIntVector(
+			FMath::FloorToInt(Nodes[i].Location.X / NodeSpacing),
+			FMath::FloorToInt(Nodes[i].Location.Y / NodeSpacing),
+			FMath::FloorToInt(Nodes[i].Location.Z / NodeSpacing));
+		nodeGrid.FindOrAdd(cell).Add(i);
+	}
+}
+
+int32 AClimbNavGraph::FindNearestNode(const FVector& location) const {
+	const auto center = FIntVector(
+		FMath::FloorToInt(location.X / NodeSpacing),
+		FMath::FloorToInt(location.Y / NodeSpacing),
+		FMath::FloorToInt(location.Z / NodeSpacing));
+
+	auto nearest = INDEX_NONE;
+	auto nearestDistSquared = FMath::Square(static_cast<double>(MaxNodeSnapDistance));
+	const auto maxRing = FMath::Max(1, FMath::CeilToInt(MaxNodeSnapDistance / NodeSpacing));
+
+	// shells of cells outwards, a node beyond ring r is at least r cells away so a closer hit ends the search
+	for(auto ring = 0; ring <= maxRing; ++ring) {
+		for(auto x = -ring; x <= ring; ++x) {
+			for(auto y = -ring; y <= ring; ++y) {
+				for(auto z = -ring; z <= ring; ++z) {
+					if(FMath::Max3(FMath::Abs(x), FMath::Abs(y), FMath::Abs(z)) != ring) { continue; }
+
+					const auto* bucket = nodeGrid.Find(center + FIntVector(x, y, z));
+					if(!bucket) { continue; }
+
+					for(const auto node : *bucket) {
+						const auto distSquared = FVector::DistSquared(Nodes[node].Location, location);
+						if(distSquared <= nearestDistSquared) {
+							nearestDistSquared = distSquared;
+							nearest = node;
+						}
+					}
+				}
+			}
+		}
+
+		if(nearest != INDEX_NONE && nearestDistSquared <= FMath::Square(ring * static_cast<double>(NodeSpacing))) { break; }
+	}
+
+	return nearest;
+}
+
+bool AClimbNavGraph::FindClimbPath(const FVector& start, const FVector& goal, TArray<FClimbNavStep>& outSteps) const {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_NavGraphSearch, NavGraphSearch);
+	outSteps.Reset();
+
+	const auto startNode = FindNearestNode(start);
+	const auto goalNode = FindNearestNode(goal);
+	if(startNode == INDEX_NONE || goalNode == INDEX_NONE) { return false; }
+
+	auto& scratch = GetThreadSearchScratch();
+	if(!Search(scratch, startNode, goalNode, MAX_flt, [](int32, float) {})) { return false; }
+
+	for(auto node = goalNode; node != startNode; node = scratch.Nodes[node].Parent) {
+		outSteps.Add(MakeStep(Edges[scratch.Nodes[node].ParentEdge].Action, Nodes[node]));
+	}
+	outSteps.Add(MakeStep(EClimbNavAction::Move, Nodes[startNode]));
+	Algo::Reverse(outSteps);
+	return true;
+}
+
+AClimbNavGraph::FSearchScratch& AClimbNavGraph::GetThreadSearchScratch() {
+	static thread_local FSearchScratch scratch;
+	return scratch;
+}
+
+bool AClimbNavGraph::Search(FSearchScratch& scratch, int32 startNode, int32 goalNode, float maxCost, TFunctionRef<void(int32, float)> onSettled) const {
+	// shared by every graph the thread searches, entries past the graph's own nodes are simply never touched
+	if(scratch.Nodes.Num() < Nodes.Num()) {
+		scratch.Nodes.SetNum(Nodes.Num());
+	}
+
+	// stamping nodes with the search generation spares clearing the scratch before every query
+	if(++scratch.Generation == 0) {
+		for(auto& searchNode : scratch.Nodes) {
+			searchNode.Generation = 0;
+		}
+		scratch.Generation = 1;
+	}
+	auto& searchNodes = scratch.Nodes;
+	const auto searchGeneration = scratch.Generation;
+
+	struct FOpenEntry {
+		float Priority;
+		int32 Node;
+	};
+	const auto byPriority = [](const FOpenEntry& a, const FOpenEntry& b) { return a.Priority < b.Priority; };
+	const auto heuristic = [&](int32 node) {
+		return goalNode == INDEX_NONE ? 0.f : static_cast<float>(FVector::Dist(Nodes[node].Location, Nodes[goalNode].Location)) / HeuristicSpeed;
+	};
+
+	TArray<FOpenEntry, TInlineAllocator<64>> open;
+	searchNodes[startNode] = FSearchNode();
+	searchNodes[startNode].Generation = searchGeneration;
+	open.HeapPush({ heuristic(startNode), startNode }, byPriority);
+
+	while(!open.IsEmpty()) {
+		FOpenEntry entry;
+		open.HeapPop(entry, byPriority, false);
+
+		auto& current = searchNodes[entry.Node];
+		if(current.bClosed) { continue; }
+		current.bClosed = true;
+
+		onSettled(entry.Node, current.Cost);
+		if(entry.Node == goalNode) { return true; }
+
+		for(auto edgeIndex = EdgeOffsets[entry.Node]; edgeIndex < EdgeOffsets[entry.Node + 1]; ++edgeIndex) {
+			const auto& edge = Edges[edgeIndex];
+			const auto cost = current.Cost + edge.Cost;
+			if(cost > maxCost) { continue; }
+
+			auto& next = searchNodes[edge.To];
+			if(next.Generation != searchGeneration) {
+				next = FSearchNode();
+				next.Generation = searchGeneration;
+				next.Cost = MAX_flt;
+			}
+			if(next.bClosed || cost >= next.Cost) { continue; }
+
+			next.Cost = cost;
+			next.Parent = entry.Node;
+			next.ParentEdge = edgeIndex;
+			open.HeapPush({ cost + heuristic(edge.To), edge.To }, byPriority);
+		}
+	}
+
+	return goalNode == INDEX_NONE;
+}
+
+#pragma region NavLinks
+bool AClimbNavGraph::GetNavigationLinksClasses(TArray<TSubclassOf<UNavLinkDefinition>>& OutClasses) const {
+	return false;
+}
+
+bool AClimbNavGraph::GetNavigationLinksArray(TArray<FNavigationLink>& OutLink, TArray<FNavigationSegmentLink>& OutSegments) const {
+	OutLink.Append(NavLinks);
+	return !NavLinks.IsEmpty();
+}
+
+void AClimbNavGraph::GetNavigationData(FNavigationRelevantData& Data) const {
+	if(bEmitNavLinks) {
+		NavigationHelper::ProcessNavLinkAndAppend(&Data.Modifiers, this, NavLinks);
+	}
+}
+
+FBox AClimbNavGraph::GetNavigationBounds() const {
+	FBox bounds(ForceInit);
+	for(const auto& node : Nodes) {
+		bounds += node.Location;
+	}
+	return bounds.ExpandBy(NodeSpacing);
+}
+
+bool AClimbNavGraph::IsNavigationRelevant() const {
+	return bEmitNavLinks && !NavLinks.IsEmpty();
+}
+#pragma endregion
+
+#if WITH_EDITOR
+void AClimbNavGraph::Bake() {
+	auto* world = GetWorld();
+	if(!world) { return; }
+
+	const AClimbSurfaceIndex* surfaceIndex = nullptr;
+	for(TActorIterator<AClimbSurfaceIndex> it(world); it; ++it) {
+		if(it->IsBaked()) {
+			surfaceIndex = *it;
+			break;
+		}
+	}
+	if(!surfaceIndex) {
+		UE_LOG(LogClimbing, Warning, TEXT("%s: no baked AClimbSurfaceIndex in the level, bake that first"), *GetName());
+		return;
+	}
+
+	FBakeParams params;
+	if(!ResolveBakeParams(params)) {
+		UE_LOG(LogClimbing, Warning, TEXT("%s: ClimberClass %s has no UCustomMovementComponent to bake the climb limits from"), *GetName(), *GetNameSafe(ClimberClass));
+		return;
+	}
+
+	Modify();
+	Nodes.Reset();
+	EdgeOffsets.Reset();
+	Edges.Reset();
+	NavLinks.Reset();
+
+	BakeNodes(*surfaceIndex, params);
+	BuildNodeGrid();
+	BakeEdges(params);
+	BakeNavLinks();
+
+	UNavigationSystemV1::UpdateActorInNavOctree(*this);
+	UE_LOG(LogClimbing, Log, TEXT("%s: baked %d nodes, %d edges and %d nav links"), *GetName(), Nodes.Num(), Edges.Num(), NavLinks.Num());
+}
+
+void AClimbNavGraph::PostEditUndo() {
+	Super::PostEditUndo();
+	BuildNodeGrid();
+}
+
+bool AClimbNavGraph::ResolveBakeParams(FBakeParams& outParams) const {
+	const auto* climber = ClimberClass ? ClimberClass->GetDefaultObject<AClimbingSystemCharacter>() : nullptr;
+	const auto* movement = climber ? climber->GetCustomMovementComponent() : nullptr;
+	if(!movement) { return false; }
+
+	const auto traversal = movement->GetNavTraversalParams();
+	const auto orFallback = [](float duration, float fallbackCost) { return duration > 0.f ? duration : fallbackCost; };
+
+	outParams.WallHangOffset = climber->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
+	outParams.StandHeight = climber->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	outParams.ClimbSpeed = FMath::Max(traversal.ClimbSpeed, 1.f);
+	outParams.HopUpReach = traversal.HopUpReach;
+	outParams.HopDownReach = traversal.HopDownReach;
+	outParams.VaultLandClearance = traversal.VaultLandClearance;
+	outParams.StartClimbingCost = orFallback(traversal.StartClimbingDuration, StartClimbingCost);
+	outParams.HopUpCost = orFallback(traversal.HopUpDuration, HopCost);
+	outParams.HopDownCost = orFallback(traversal.HopDownDuration, HopCost);
+	outParams.ClimbUpCost = orFallback(traversal.ClimbUpDuration, ClimbUpCost);
+	outParams.ClimbDownCost = orFallback(traversal.ClimbDownDuration, ClimbDownCost);
+	outParams.VaultCost = orFallback(traversal.VaultDuration, VaultCost);
+	return true;
+}
+
+void AClimbNavGraph::BakeNodes(const AClimbSurfaceIndex& surfaceIndex, const FBakeParams& params) {
+	const auto cellSize = surfaceIndex.GetCellSize();
+	const auto entryMinCells = FMath::Max(1, FMath::FloorToInt(EntryMinHeight / cellSize));
+	const auto entryMaxCells = FMath::CeilToInt(EntryMaxHeight / cellSize);
+	const auto vaultLandCells = FMath::CeilToInt(params.VaultLandClearance / cellSize);
+
+	auto findFloorBelow = [&](const FIntVector& coord, int32 minCells, int32 maxCells, FIntVector& outFloor) {
+		for(auto dz = minCells; dz <= maxCells; ++dz) {
+			const auto floorCoord = coord - FIntVector(0, 0, dz);
+			if(surfaceIndex.CellHasAnyFlags(floorCoord, EClimbSurfaceCellFlags::Walkable)) {
+				outFloor = floorCoord;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// keep the cell closest to the middle of each NodeSpacing cell per node type, so graph density follows NodeSpacing rather than the index resolution
+	struct FNodeCandidate {
+		FClimbNavNode Node;
+		double DistSquared = MAX_dbl;
+	};
+	TMap<TTuple<uint8, FIntVector>, FNodeCandidate> candidates;
+	auto offerNode = [&](const FClimbNavNode& node) {
+		const auto bucket = FIntVector(
+			FMath::FloorToInt(node.Anchor.X / NodeSpacing),
+			FMath::FloorToInt(node.Anchor.Y / NodeSpacing),
+			FMath::FloorToInt(node.Anchor.Z / NodeSpacing));
+		const auto distSquared = FVector::DistSquared(node.Anchor, (FVector(bucket) + 0.5f) * NodeSpacing);
+
+		auto& candidate = candidates.FindOrAdd(MakeTuple(static_cast<uint8>(node.Type), bucket));
+		if(distSquared < candidate.DistSquared) {
+			candidate.Node = node;
+			candidate.DistSquared = distSquared;
+		}
+	};
+
+	for(const auto& cell : surfaceIndex.GetCells()) {
+		const auto coord = AClimbSurfaceIndex::UnpackCellKey(cell.Key);
+		const auto center = surfaceIndex.ToCellCenter(coord);
+		const auto normal = FVector(cell.Normal);
+
+		if(cell.HasAnyFlags(EClimbSurfaceCellFlags::Climbable)) {
+			FClimbNavNode wall;
+			wall.Type = EClimbNavNodeType::Wall;
+			wall.Location = center + normal * params.WallHangOffset;
+			wall.Anchor = wall.Location;
+			wall.Normal = cell.Normal;
+			offerNode(wall);
+
+			const auto outward = FIntVector(FMath::RoundToInt(normal.X), FMath::RoundToInt(normal.Y), 0);
+
+			FIntVector floorCoord;
+			if(findFloorBelow(coord + outward, entryMinCells, entryMaxCells, floorCoord)) {
+				auto entry = wall;
+				entry.Type = EClimbNavNodeType::WallEntry;
+				entry.Location = FVector(wall.Location.X, wall.Location.Y, surfaceIndex.ToCellCenter(floorCoord).Z + params.StandHeight);
+				offerNode(entry);
+			}
+
+			if(cell.HasAnyFlags(EClimbSurfaceCellFlags::LedgeEdge)) {
+				for(const auto& topOffset : { FIntVector(0, 0, 1) - outward, -outward, FIntVector(0, 0, 1) }) {
+					if(!surfaceIndex.CellHasAnyFlags(coord + topOffset, EClimbSurfaceCellFlags::Walkable)) { continue; }
+
+					auto ledge = wall;
+					ledge.Type = EClimbNavNodeType::Ledge;
+					ledge.Location = surfaceIndex.ToCellCenter(coord + topOffset) - normal * params.WallHangOffset + FVector::UpVector * params.StandHeight;
+					offerNode(ledge);
+					break;
+				}
+			}
+			continue;
+		}
+
+		if(!cell.HasAnyFlags(EClimbSurfaceCellFlags::Vaultable)) { continue; }
+
+		// a vault start keeps its landing in Anchor until the land node is split off below
+		for(const auto& direction : { FIntVector(1, 0, 0), FIntVector(-1, 0, 0), FIntVector(0, 1, 0), FIntVector(0, -1, 0) }) {
+			FIntVector nearFloor, farFloor;
+			if(!findFloorBelow(coord - direction, 1, entryMaxCells, nearFloor)) { continue; }
+			if(!findFloorBelow(coord + direction * vaultLandCells, 1, entryMaxCells, farFloor)) { continue; }
+
+			FClimbNavNode vault;
+			vault.Type = EClimbNavNodeType::VaultStart;
+			vault.Location = surfaceIndex.ToCellCenter(nearFloor) - FVector(direction) * params.WallHangOffset + FVector::UpVector * params.StandHeight;
+			vault.Anchor = surfaceIndex.ToCellCenter(farFloor) + FVector::UpVector * params.StandHeight;
+			vault.Normal = FVector3f(-FVector(direction));
+			offerNode(vault);
+		}
+	}
+
+	Nodes.Reserve(candidates.Num());
+	for(const auto& [key, candidate] : candidates) {
+		Nodes.Add(candidate.Node);
+		if(candidate.Node.Type != EClimbNavNodeType::VaultStart) { continue; }
+
+		// BakeEdges relies on the landing directly following its start
+		auto& start = Nodes.Last();
+		FClimbNavNode land;
+		land.Type = EClimbNavNodeType::VaultLand;
+		land.Location = start.Anchor;
+		land.Anchor = start.Anchor;
+		start.Anchor = start.Location;
+		Nodes.Add(land);
+	}
+}
+
+void AClimbNavGraph::BakeEdges(const FBakeParams& params) {
+	TArray<TArray<FClimbNavEdge, TInlineAllocator<8>>> adjacency;
+	adjacency.SetNum(Nodes.Num());
+	auto addEdge = [&](int32 from, int32 to, EClimbNavAction action, float cost) {
+		adjacency[from].Add({ to, cost, action });
+	};
+
+	const auto linkDistance = NodeSpacing * 1.5f;
+	const auto searchCells = FMath::CeilToInt(FMath::Max(params.HopUpReach, params.HopDownReach) / NodeSpacing) + 1;
+
+	for(auto i = 0; i < Nodes.Num(); ++i) {
+		const auto& node = Nodes[i];
+		if(node.Type == EClimbNavNodeType::VaultStart) {
+			addEdge(i, i + 1, EClimbNavAction::Vault, params.VaultCost);
+			continue;
+		}
+		// entry and ledge edges both ways are added from the wall node they attach to
+		if(node.Type != EClimbNavNodeType::Wall) { continue; }
+
+		const auto center = FIntVector(
+			FMath::FloorToInt(node.Location.X / NodeSpacing),
+			FMath::FloorToInt(node.Location.Y / NodeSpacing),
+			FMath::FloorToInt(node.Location.Z / NodeSpacing));
+
+		for(auto x = -searchCells; x <= searchCells; ++x) {
+			for(auto y = -searchCells; y <= searchCells; ++y) {
+				for(auto z = -searchCells; z <= searchCells; ++z) {
+					const auto* bucket = nodeGrid.Find(center + FIntVector(x, y, z));
+					if(!bucket) { continue; }
+
+					for(const auto j : *bucket) {
+						const auto& other = Nodes[j];
+						if(j == i || FVector3f::DotProduct(node.Normal, other.Normal) < ClimbNavSameFaceMinDot) { continue; }
+
+						const auto delta = other.Anchor - node.Anchor;
+						const auto distance = static_cast<float>(delta.Size());
+						const auto bStacked = delta.Size2D() <= NodeSpacing * 0.75f;
+
+						switch(other.Type) {
+							case EClimbNavNodeType::Wall:
+								if(distance <= linkDistance) {
+									addEdge(i, j, EClimbNavAction::Climb, distance / params.ClimbSpeed);
+								} else if(bStacked && delta.Z > linkDistance && delta.Z <= params.HopUpReach) {
+									addEdge(i, j, EClimbNavAction::HopUp, params.HopUpCost);
+								} else if(bStacked && -delta.Z > linkDistance && -delta.Z <= params.HopDownReach) {
+									addEdge(i, j, EClimbNavAction::HopDown, params.HopDownCost);
+								}
+								break;
+							case EClimbNavNodeType::WallEntry:
+								if(distance <= linkDistance) {
+									addEdge(j, i, EClimbNavAction::StartClimbing, params.StartClimbingCost);
+									addEdge(i, j, EClimbNavAction::StopClimbing, FVector::Dist(node.Location, other.Location) / params.ClimbSpeed);
+								}
+								break;
+							case EClimbNavNodeType::Ledge:
+								if(distance <= linkDistance) {
+									addEdge(i, j, EClimbNavAction::ClimbUp, params.ClimbUpCost);
+									addEdge(j, i, EClimbNavAction::ClimbDown, params.ClimbDownCost);
+								}
+								break;
+							default:
+								break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// flatten into one edge array and take the fastest edge for the heuristic while at it
+	EdgeOffsets.Reset(Nodes.Num() + 1);
+	HeuristicSpeed = params.ClimbSpeed;
+	for(auto i = 0; i < Nodes.Num(); ++i) {
+		EdgeOffsets.Add(Edges.Num());
+		for(const auto& edge : adjacency[i]) {
+			Edges.Add(edge);
+			const auto length = FVector::Dist(Nodes[i].Location, Nodes[edge.To].Location);
+			HeuristicSpeed = FMath::Max(HeuristicSpeed, static_cast<float>(length) / FMath::Max(edge.Cost, 0.01f));
+		}
+	}
+	EdgeOffsets.Add(Edges.Num());
+}
+
+void AClimbNavGraph::BakeNavLinks() {
+	if(!bEmitNavLinks) { return; }
+
+	const auto& actorTransform = GetActorTransform();
+	auto addLink = [&](const FVector& from, const FVector& to) {
+		FNavigationLink link(actorTransform.InverseTransformPosition(from), actorTransform.InverseTransformPosition(to));
+		link.Direction = ENavLinkDirection::LeftToRight;
+		link.SetAreaClass(UClimbNavArea::StaticClass());
+		NavLinks.Add(link);
+	};
+
+	for(auto i = 0; i < Nodes.Num(); ++i) {
+		const auto& node = Nodes[i];
+		if(node.Type == EClimbNavNodeType::VaultStart) {
+			addLink(node.Location, Nodes[i + 1].Location);
+			continue;
+		}
+		if(node.Type != EClimbNavNodeType::WallEntry && node.Type != EClimbNavNodeType::Ledge) { continue; }
+
+		// only routes that change floors, the navmesh already walks between spots on the same one
+		auto numLinks = 0;
+		Search(GetThreadSearchScratch(), i, INDEX_NONE, MaxNavLinkCost, [&](int32 reached, float) {
+			const auto& other = Nodes[reached];
+			if(reached == i || numLinks >= MaxNavLinksPerNode) { return; }
+			if(other.Type != EClimbNavNodeType::WallEntry && other.Type != EClimbNavNodeType::Ledge) { return; }
+			if(FMath::Abs(other.Location.Z - node.Location.Z) <= NodeSpacing) { return; }
+
+			addLink(node.Location, other.Location);
+			++numLinks;
+		});
+	}
+}
+#endif
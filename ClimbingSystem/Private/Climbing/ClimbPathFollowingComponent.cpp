@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbPathFollowingComponent.h"
+#include "Climbing/ClimbNavArea.h"
+#include "Components/CustomMovementComponent.h"
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "Debug/ClimbLog.h"
+#include "NavigationData.h"
+#include "EngineUtils.h"
+
+void UClimbPathFollowingComponent::SetMoveSegment(int32 SegmentStartIndex) {
+	ResetClimbRoute();
+	Super::SetMoveSegment(SegmentStartIndex);
+
+	if(IsClimbLinkSegment(SegmentStartIndex)) {
+		const auto& points = Path->GetPathPoints();
+		StartClimbRoute(points[SegmentStartIndex].Location, points[SegmentStartIndex + 1].Location);
+	}
+}
+
+bool UClimbPathFollowingComponent::IsClimbLinkSegment(int32 SegmentStartIndex) const {
+	if(!Path.IsValid() || !MyNavData) { return false; }
+
+	const auto& points = Path->GetPathPoints();
+	if(!points.IsValidIndex(SegmentStartIndex + 1)) { return false; }
+
+	const FNavMeshNodeFlags flags(points[SegmentStartIndex].Flags);
+	return flags.IsNavLink() && flags.Area == MyNavData->GetAreaID(UClimbNavArea::StaticClass());
+}
+
+void UClimbPathFollowingComponent::StartClimbRoute(const FVector& linkStart, const FVector& linkEnd) {
+	auto* graph = GetClimbNavGraph();
+	if(!graph || !graph->FindClimbPath(linkStart, linkEnd, climbSteps) || climbSteps.IsEmpty()) {
+		// left to the navmesh's straight segment, which blocks on the wall
+		CLIMB_LOG_RATE_LIMITED(Warning, GetOwner(), 5.f, TEXT("%s reached a climb link but found no climb route across it"), *GetNameSafe(GetOwner()));
+		climbSteps.Reset();
+		return;
+	}
+
+	climbStepIndex = 0;
+}
+
+void UClimbPathFollowingComponent::ResetClimbRoute() {
+	climbSteps.Reset();
+	climbStepIndex = INDEX_NONE;
+	climbStepTime = 0.f;
+	bClimbStepRequested = false;
+	bClimbActionStarted = false;
+}
+
+void UClimbPathFollowingComponent::UpdatePathSegment() {
+	// the navmesh's arrival and block checks do not apply along the climb route, FollowPathSegment ends it instead
+	if(IsFollowingClimbRoute()) { return; }
+
+	Super::UpdatePathSegment();
+}
+
+void UClimbPathFollowingComponent::FollowPathSegment(float DeltaTime) {
+	if(!IsFollowingClimbRoute()) {
+		Super::FollowPathSegment(DeltaTime);
+		return;
+	}
+
+	auto* character = Cast<AClimbingSystemCharacter>(MovementComp ? MovementComp->GetOwner() : nullptr);
+	auto* movement = character ? character->GetCustomMovementComponent() : nullptr;
+	if(!movement) {
+		OnPathFinished(FPathFollowingResult(EPathFollowingResult::Aborted, FPathFollowingResultFlags::None));
+		return;
+	}
+
+	if(UpdateClimbStep(*character, *movement, climbSteps[climbStepIndex])) {
+		++climbStepIndex;
+		climbStepTime = 0.f;
+		bClimbStepRequested = false;
+		bClimbActionStarted = false;
+		if(climbStepIndex >= climbSteps.Num()) {
+			FinishClimbRoute();
+		}
+		return;
+	}
+
+	climbStepTime += DeltaTime;
+	if(climbStepTime > ClimbStepTimeout) {
+		CLIMB_LOG(Warning, TEXT("%s timed out on climb step %d of %d"), *GetNameSafe(character), climbStepIndex, climbSteps.Num());
+		OnPathFinished(FPathFollowingResult(EPathFollowingResult::Blocked, FPathFollowingResultFlags::None));
+	}
+}
+
+bool UClimbPathFollowingComponent::UpdateClimbStep(AClimbingSystemCharacter& character, UCustomMovementComponent& movement, const FClimbNavStep& step) {
+	const auto toStep = step.Location - character.GetActorLocation();
+	const auto bReached = toStep.Size() <= ClimbStepAcceptanceRadius;
+
+	// climb montages play after the request runs at the start of a later move, so a request is done once its montage has come and gone
+	bClimbActionStarted |= movement.IsClimbActionPlaying();
+	const auto bActionFinished = bClimbActionStarted && !movement.IsClimbActionPlaying();
+
+	// entry traces and vaults look along the actor's forward vector
+	const auto faceStep = [&]() {
+		const auto facing = step.Normal.IsNearlyZero() ? toStep.GetSafeNormal2D() : -step.Normal.GetSafeNormal2D();
+		if(!facing.IsNearlyZero()) {
+			character.SetActorRotation(facing.Rotation());
+		}
+	};
+
+	switch(step.Action) {
+	case EClimbNavAction::Move:
+		if(bReached) { return true; }
+		character.AddMovementInput(toStep.GetSafeNormal2D());
+		return false;
+
+	case EClimbNavAction::Climb:
+		if(bReached) { return true; }
+		character.AddMovementInput(toStep.GetSafeNormal());
+		return false;
+
+	case EClimbNavAction::StartClimbing:
+	case EClimbNavAction::ClimbDown:
+		if(movement.IsClimbing() && !movement.IsClimbActionPlaying()) { return true; }
+		if(!bClimbStepRequested) {
+			faceStep();
+			movement.ToggleClimbing(true);
+			bClimbStepRequested = true;
+		}
+		return false;
+
+	case EClimbNavAction::StopClimbing:
+		if(!movement.IsClimbing()) { return true; }
+		if(!bClimbStepRequested) {
+			movement.ToggleClimbing(false);
+			bClimbStepRequested = true;
+		}
+		return false;
+
+	case EClimbNavAction::HopUp:
+	case EClimbNavAction::HopDown: {
+		if(bReached || bActionFinished) { return true; }
+		// HandleHopping picks the hop from the move's acceleration
+		const auto up = character.GetActorUpVector();
+		character.AddMovementInput(step.Action == EClimbNavAction::HopUp ? up : -up);
+		if(!bClimbStepRequested) {
+			movement.RequestHopping();
+			bClimbStepRequested = true;
+		}
+		return false;
+	}
+
+	case EClimbNavAction::ClimbUp:
+		// PhysClimb climbs onto the ledge by itself once the character reaches the top
+		if(!movement.IsClimbing() && !movement.IsClimbActionPlaying()) { return true; }
+		character.AddMovementInput(character.GetActorUpVector());
+		return false;
+
+	case EClimbNavAction::Vault:
+		if(bActionFinished) { return true; }
+		if(!bClimbStepRequested) {
+			faceStep();
+			movement.RequestVaulting();
+			bClimbStepRequested = true;
+		}
+		return false;
+	}
+
+	return true;
+}
+
+void UClimbPathFollowingComponent::FinishClimbRoute() {
+	ResetClimbRoute();
+
+	// the route ends at the link's end point, carry on from there or finish when that was the goal
+	if(!Path.IsValid() || MoveSegmentStartIndex + 2 >= Path->GetPathPoints().Num()) {
+		OnPathFinished(FPathFollowingResult(EPathFollowingResult::Success, FPathFollowingResultFlags::None));
+		return;
+	}
+
+	SetNextMoveSegment();
+}
+
+void UClimbPathFollowingComponent::OnPathFinished(const FPathFollowingResult& Result) {
+	ResetClimbRoute();
+	Super::OnPathFinished(Result);
+}
+
+AClimbNavGraph* UClimbPathFollowingComponent::GetClimbNavGraph() {
+	if(!climbNavGraph.IsValid()) {
+		for(TActorIterator<AClimbNavGraph> it(GetWorld()); it; ++it) {
+			if(it->IsBaked()) {
+				climbNavGraph = *it;
+				break;
+			}
+		}
+	}
+
+	return climbNavGraph.Get();
+}
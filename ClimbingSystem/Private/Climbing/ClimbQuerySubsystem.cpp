@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbQuerySubsystem.h"
+#include "Climbing/ClimbingStats.h"
+#include "Components/CustomMovementComponent.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+namespace {
+	// segments closer than this are the same query for our purposes, well under the capsule radius
+	constexpr float ClimbQueryDedupGrid = 2.f;
+	// below this many queries the task overhead costs more than it saves
+	constexpr int32 ClimbQueryMinParallelBatch = 8;
+
+	FIntVector QuantizeQueryPoint(const FVector& point) {
+		return FIntVector(
+			FMath::RoundToInt(point.X / ClimbQueryDedupGrid),
+			FMath::RoundToInt(point.Y / ClimbQueryDedupGrid),
+			FMath::RoundToInt(point.Z / ClimbQueryDedupGrid));
+	}
+}
+
+void FClimbQueryBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) {
+	if(Subsystem) {
+		Subsystem->RunBatch();
+	}
+}
+
+FString FClimbQueryBatchTickFunction::DiagnosticMessage() {
+	return TEXT("FClimbQueryBatchTickFunction");
+}
+
+FName FClimbQueryBatchTickFunction::DiagnosticContext(bool bDetailed) {
+	return FName(TEXT("ClimbQueryBatch"));
+}
+
+void UClimbQuerySubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	batchTickFunction.Subsystem = this;
+	batchTickFunction.bCanEverTick = true;
+	batchTickFunction.bStartWithTickEnabled = true;
+	batchTickFunction.TickGroup = TG_PrePhysics;
+	batchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UClimbQuerySubsystem::Deinitialize() {
+	if(batchTickFunction.IsTickFunctionRegistered()) {
+		batchTickFunction.UnRegisterTickFunction();
+	}
+	climbers.Reset();
+
+	Super::Deinitialize();
+}
+
+void UClimbQuerySubsystem::RegisterClimber(UCustomMovementComponent* climber) {
+	if(!climber) { return; }
+
+	climbers.AddUnique(climber);
+	climber->PrimaryComponentTick.AddPrerequisite(this, batchTickFunction);
+}
+
+void UClimbQuerySubsystem::UnregisterClimber(UCustomMovementComponent* climber) {
+	if(!climber) { return; }
+
+	climbers.RemoveSingleSwap(climber);
+	climber->PrimaryComponentTick.RemovePrerequisite(this, batchTickFunction);
+}
+
+int32 UClimbQuerySubsystem::AddSweep(const FVector& start, const FVector& end, const FCollisionShape& shape, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams) {
+	return AddQuery(start, end, shape, true, objectParams, queryParams);
+}
+
+int32 UClimbQuerySubsystem::AddLineTrace(const FVector& start, const FVector& end, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams) {
+	return AddQuery(start, end, FCollisionShape::LineShape, false, objectParams, queryParams);
+}
+
+int32 UClimbQuerySubsystem::AddQuery(const FVector& start, const FVector& end, const FCollisionShape& shape, bool bSweep, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams) {
+	++numRequests;
+
+	const FQueryKey key = {
+		QuantizeQueryPoint(start),
+		QuantizeQueryPoint(end),
+		FVector3f(shape.GetExtent()),
+		objectParams.GetQueryBitfield(),
+		static_cast<uint8>(queryParams.MobilityType),
+		static_cast<uint8>(bSweep)
+	};
+	if(const auto* existing = queryLookup.Find(key)) {
+		return *existing;
+	}
+
+	if(numQueries == queries.Num()) {
+		queries.AddDefaulted();
+	}
+	auto& query = queries[numQueries];
+	query.Start = start;
+	query.End = end;
+	query.Shape = shape;
+	query.ObjectParams = &objectParams;
+	query.QueryParams = &queryParams;
+	query.bSweep = bSweep;
+
+	queryLookup.Add(key, numQueries);
+	return numQueries++;
+}
+
+void UClimbQuerySubsystem::RunBatch() {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_QueryBatch, ClimbQueryBatch);
+
+	++batchNumber;
+	numQueries = 0;
+	numRequests = 0;
+	queryLookup.Reset();
+
+	climbers.RemoveAllSwap([](const TWeakObjectPtr<UCustomMovementComponent>& climber) { return !climber.IsValid(); });
+	for(const auto& climber : climbers) {
+		climber->GatherBatchedClimbQueries(*this);
+	}
+	if(numQueries == 0) { return; }
+
+	// scene queries only read the physics scene, which is not stepping yet in pre-physics
+	const auto* world = GetWorld();
+	ParallelFor(numQueries, [this, world](int32 index) {
+		auto& query = queries[index];
+		query.Hits.Reset();
+		if(query.bSweep) {
+			world->SweepMultiByObjectType(query.Hits, query.Start, query.End, FQuat::Identity, *query.ObjectParams, query.Shape, *query.QueryParams);
+		} else {
+			FHitResult hit;
+			if(world->LineTraceSingleByObjectType(hit, query.Start, query.End, *query.ObjectParams, *query.QueryParams)) {
+				query.Hits.Add(hit);
+			}
+		}
+	}, bForceSingleThread || numQueries < ClimbQueryMinParallelBatch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	INC_DWORD_STAT_BY(STAT_Climb_SceneQueries, numQueries);
+	INC_DWORD_STAT_BY(STAT_Climb_BatchedQueryRequests, numRequests);
+	INC_DWORD_STAT_BY(STAT_Climb_BatchedUniqueQueries, numQueries);
+}
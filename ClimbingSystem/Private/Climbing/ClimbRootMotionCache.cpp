@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbRootMotionCache.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include "Animation/AnimMontage.h"
+
+#if WITH_EDITOR
+#include "AnimNotifyState_MotionWarping.h"
+#include "RootMotionModifier.h"
+#endif
+
+FVector FClimbBakedRootMotion::Evaluate(float time) const {
+	if(!IsValid()) { return FVector::ZeroVector; }
+
+	const auto sample = FMath::Clamp(time, 0.f, Duration) / SampleInterval;
+	const auto index = FMath::Min(FMath::FloorToInt(sample), Translations.Num() - 1);
+	const auto nextIndex = FMath::Min(index + 1, Translations.Num() - 1);
+
+	return FVector(FMath::Lerp(Translations[index], Translations[nextIndex], sample - index));
+}
+
+const FClimbBakedRootMotion* UClimbRootMotionCache::Find(const UAnimMontage* montage) const {
+	if(!montage) { return nullptr; }
+
+	const auto* curve = Curves.Find(montage->GetFName());
+	return curve && curve->IsValid() ? curve : nullptr;
+}
+
+#if WITH_EDITOR
+void UClimbRootMotionCache::Bake() {
+	Modify();
+	Curves.Reset();
+
+	const auto sampleInterval = 1.f / BakeSampleRate;
+	for(const auto& softMontage : SourceMontages) {
+		const auto* montage = softMontage.LoadSynchronous();
+		if(!montage) { continue; }
+
+		FClimbBakedRootMotion baked;
+		baked.Duration = montage->GetPlayLength();
+		baked.SampleInterval = sampleInterval;
+
+		const auto numSamples = FMath::CeilToInt(baked.Duration / sampleInterval) + 1;
+		baked.Translations.Reserve(numSamples);
+		for(int32 i = 0; i < numSamples; ++i) {
+			const auto time = FMath::Min(i * sampleInterval, baked.Duration);
+			baked.Translations.Add(FVector3f(montage->ExtractRootMotionFromTrackRange(0.f, time).GetTranslation()));
+		}
+
+		for(const auto& notify : montage->Notifies) {
+			const auto* warpNotify = Cast<UAnimNotifyState_MotionWarping>(notify.NotifyStateClass);
+			const auto* warpModifier = warpNotify ? Cast<URootMotionModifier_Warp>(warpNotify->RootMotionModifier) : nullptr;
+			if(!warpModifier) { continue; }
+
+			baked.WarpWindows.Add({ warpModifier->WarpTargetName, notify.GetTriggerTime(), notify.GetEndTriggerTime() });
+		}
+		baked.WarpWindows.Sort([](const FClimbWarpWindow& a, const FClimbWarpWindow& b) { return a.EndTime < b.EndTime; });
+
+		UE_LOG(LogClimbing, Log, TEXT("%s: baked %s, %d samples, %d warp windows"), *GetName(), *montage->GetName(), numSamples, baked.WarpWindows.Num());
+		Curves.Add(montage->GetFName(), MoveTemp(baked));
+	}
+}
+#endif
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbRootMotionSource.h"
+#include "Climbing/ClimbRootMotionCache.h"
+#include "GameFramework/Character.h"
+
+FRootMotionSource_ClimbCurve::FRootMotionSource_ClimbCurve() {
+	// climb actions own the character's movement while they play, same as the montages they replace
+	AccumulateMode = ERootMotionAccumulateMode::Override;
+}
+
+void FRootMotionSource_ClimbCurve::InitWarpOffsets(const FClimbBakedRootMotion& curve, const TMap<FName, FVector>& warpTargets, const FVector& rootToActorOffset) {
+	WarpOffsets.Reset(curve.WarpWindows.Num());
+
+	auto accumulatedOffset = FVector::ZeroVector;
+	for(const auto& window : curve.WarpWindows) {
+		const auto* target = warpTargets.Find(window.WarpTargetName);
+		if(!target) {
+			WarpOffsets.Add(FVector::ZeroVector);
+			continue;
+		}
+
+		const auto unwarpedLocation = StartLocation + CurveToWorld.RotateVector(curve.Evaluate(window.EndTime)) + accumulatedOffset;
+		const auto offset = (*target + rootToActorOffset) - unwarpedLocation;
+		WarpOffsets.Add(offset);
+		accumulatedOffset += offset;
+	}
+}
+
+FVector FRootMotionSource_ClimbCurve::EvaluateWorldLocation(const FClimbBakedRootMotion& curve, float time) const {
+	auto location = StartLocation + CurveToWorld.RotateVector(curve.Evaluate(time));
+
+	for(int32 i = 0; i < curve.WarpWindows.Num() && i < WarpOffsets.Num(); ++i) {
+		const auto& window = curve.WarpWindows[i];
+		const auto windowLength = window.EndTime - window.StartTime;
+		const auto alpha = windowLength > UE_SMALL_NUMBER ? FMath::Clamp((time - window.StartTime) / windowLength, 0.f, 1.f) : (time >= window.EndTime ? 1.f : 0.f);
+		location += WarpOffsets[i] * alpha;
+	}
+
+	return location;
+}
+
+FRootMotionSource* FRootMotionSource_ClimbCurve::Clone() const {
+	return new FRootMotionSource_ClimbCurve(*this);
+}
+
+bool FRootMotionSource_ClimbCurve::Matches(const FRootMotionSource* Other) const {
+	if(!FRootMotionSource::Matches(Other)) { return false; }
+
+	// Matches() is only called on sources of the same script struct
+	const auto* otherCast = static_cast<const FRootMotionSource_ClimbCurve*>(Other);
+	return Cache == otherCast->Cache &&
+		CurveName == otherCast->CurveName &&
+		StartLocation.Equals(otherCast->StartLocation, 1.f);
+}
+
+bool FRootMotionSource_ClimbCurve::MatchesAndHasSameState(const FRootMotionSource* Other) const {
+	return FRootMotionSource::MatchesAndHasSameState(Other) && Matches(Other);
+}
+
+bool FRootMotionSource_ClimbCurve::UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup) {
+	return FRootMotionSource::UpdateStateFrom(SourceToTakeStateFrom, bMarkForSimulatedCatchup);
+}
+
+void FRootMotionSource_ClimbCurve::PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent) {
+	RootMotionParams.Clear();
+
+	const auto* curve = Cache ? Cache->Find(CurveName) : nullptr;
+	if(curve && Duration > UE_SMALL_NUMBER && MovementTickTime > UE_SMALL_NUMBER) {
+		// steer toward where the curve says we should be, so sub-stepping and corrections cannot drift
+		const auto targetLocation = EvaluateWorldLocation(*curve, GetTime() + SimulationTime);
+		const auto force = (targetLocation - Character.GetActorLocation()) / MovementTickTime;
+		RootMotionParams.Set(FTransform(force));
+	}
+
+	SetTime(GetTime() + SimulationTime);
+}
+
+bool FRootMotionSource_ClimbCurve::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) {
+	if(!FRootMotionSource::NetSerialize(Ar, Map, bOutSuccess)) { return false; }
+
+	Ar << Cache;
+	Ar << CurveName;
+	Ar << StartLocation;
+	Ar << CurveToWorld;
+	Ar << WarpOffsets;
+
+	bOutSuccess = true;
+	return true;
+}
+
+UScriptStruct* FRootMotionSource_ClimbCurve::GetScriptStruct() const {
+	return FRootMotionSource_ClimbCurve::StaticStruct();
+}
+
+FString FRootMotionSource_ClimbCurve::ToSimpleString() const {
+	return FString::Printf(TEXT("[ID:%u]FRootMotionSource_ClimbCurve %s %s"), LocalID, *InstanceName.GetPlainNameString(), *CurveName.ToString());
+}
+
+void FRootMotionSource_ClimbCurve::AddReferencedObjects(FReferenceCollector& Collector) {
+	Collector.AddReferencedObject(Cache);
+	FRootMotionSource::AddReferencedObjects(Collector);
+}
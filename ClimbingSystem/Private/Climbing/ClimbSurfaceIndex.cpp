@@ -0,0 +1,356 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbSurfaceIndex.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include "Algo/BinarySearch.h"
+#include "Components/PrimitiveComponent.h"
+#include "EngineUtils.h"
+
+namespace {
+	constexpr int32 CellKeyBits = 21;
+	constexpr int32 CellKeyBias = 1 << (CellKeyBits - 1);
+	constexpr uint64 CellKeyMask = (1ull << CellKeyBits) - 1;
+
+	// matches UCustomMovementComponent::CheckShouldStopClimbing, surfaces within 60 degrees of up are floors
+	const float WalkableMinNormalZ = FMath::Cos(FMath::DegreesToRadians(60.f));
+
+	// fraction of a cell a line trace accepts a plane hit outside the cell that owns the plane, and a sweep accepts a
+	// capsule axis behind a face, anything deeper is the far side of the geometry
+	constexpr float PlaneHitSlack = 0.25f;
+
+	// impact normals closer than this belong to the same face of a cell, the wall and the top of a ledge do not
+	const float FaceClusterMinNormalDot = FMath::Cos(FMath::DegreesToRadians(30.f));
+
+	void FillAggregateHit(FHitResult& outHit, const FVector& location, const FVector& normal) {
+		outHit.bBlockingHit = true;
+		outHit.ImpactPoint = location;
+		outHit.Location = location;
+		outHit.ImpactNormal = normal;
+		outHit.Normal = normal;
+	}
+}
+
+AClimbSurfaceIndex::AClimbSurfaceIndex() {
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+uint64 AClimbSurfaceIndex::PackCellKey(const FIntVector& cellCoord) {
+	const auto x = static_cast<uint64>(cellCoord.X + CellKeyBias) & CellKeyMask;
+	const auto y = static_cast<uint64>(cellCoord.Y + CellKeyBias) & CellKeyMask;
+	const auto z = static_cast<uint64>(cellCoord.Z + CellKeyBias) & CellKeyMask;
+	return (x << (CellKeyBits * 2)) | (y << CellKeyBits) | z;
+}
+
+FIntVector AClimbSurfaceIndex::UnpackCellKey(uint64 key) {
+	return FIntVector(
+		static_cast<int32>((key >> (CellKeyBits * 2)) & CellKeyMask) - CellKeyBias,
+		static_cast<int32>((key >> CellKeyBits) & CellKeyMask) - CellKeyBias,
+		static_cast<int32>(key & CellKeyMask) - CellKeyBias);
+}
+
+TArrayView<const FClimbSurfaceCell> AClimbSurfaceIndex::FindCellFaces(const FIntVector& cellCoord) const {
+	const auto key = PackCellKey(cellCoord);
+	const auto first = Algo::LowerBoundBy(Cells, key, &FClimbSurfaceCell::Key);
+	auto last = first;
+	while(last < Cells.Num() && Cells[last].Key == key) {
+		++last;
+	}
+	return MakeArrayView(Cells.GetData() + first, last - first);
+}
+
+bool AClimbSurfaceIndex::CellHasAnyFlags(const FIntVector& cellCoord, EClimbSurfaceCellFlags inFlags) const {
+	for(const auto& face : FindCellFaces(cellCoord)) {
+		if(face.HasAnyFlags(inFlags)) { return true; }
+	}
+	return false;
+}
+
+bool AClimbSurfaceIndex::LineTrace(const FVector& start, const FVector& end, FHitResult& outHit) const {
+	outHit = FHitResult(start, end);
+
+	const auto traceLength = static_cast<float>(FVector::Dist(start, end));
+	if(traceLength <= KINDA_SMALL_NUMBER) { return false; }
+	const auto direction = (end - start) / traceLength;
+
+	// visit every cell the segment crosses in order (Amanatides and Woo), all distances are along the ray
+	auto coord = ToCellCoord(start);
+	const auto endCoord = ToCellCoord(end);
+	FIntVector step = FIntVector::ZeroValue;
+	FVector nextBoundary(BIG_NUMBER), boundaryStep(BIG_NUMBER);
+	for(auto axis = 0; axis < 3; ++axis) {
+		if(FMath::IsNearlyZero(direction[axis])) { continue; }
+
+		step[axis] = direction[axis] > 0.f ? 1 : -1;
+		const auto boundary = (coord[axis] + (step[axis] > 0 ? 1 : 0)) * CellSize;
+		nextBoundary[axis] = (boundary - start[axis]) / direction[axis];
+		boundaryStep[axis] = CellSize / FMath::Abs(direction[axis]);
+	}
+
+	const auto planeSlack = CellSize * PlaneHitSlack;
+	auto cellEnter = 0.f;
+	while(true) {
+		const auto cellExit = static_cast<float>(nextBoundary.GetMin());
+
+		// the nearest face the ray enters wins, faces it would leave through are the far side of the geometry
+		const FClimbSurfaceCell* hitFace = nullptr;
+		auto hitDistance = 0.f;
+		for(const auto& face : FindCellFaces(coord)) {
+			// the fitted plane can lean slightly past its cell on curved geometry, accept hits just outside it
+			const auto normal = FVector(face.Normal);
+			const auto facing = FVector::DotProduct(normal, direction);
+			if(facing >= -KINDA_SMALL_NUMBER) { continue; }
+
+			const auto distance = static_cast<float>((face.PlaneDistance - FVector::DotProduct(normal, start)) / facing);
+			if(distance >= FMath::Max(0.f, cellEnter - planeSlack) && distance <= FMath::Min(traceLength, cellExit + planeSlack) &&
+			   (!hitFace || distance < hitDistance)) {
+				hitFace = &face;
+				hitDistance = distance;
+			}
+		}
+		if(hitFace) {
+			const auto normal = FVector(hitFace->Normal);
+			const auto impactPoint = start + direction * hitDistance;
+			outHit.bBlockingHit = true;
+			outHit.Time = hitDistance / traceLength;
+			outHit.Distance = hitDistance;
+			outHit.ImpactPoint = impactPoint;
+			outHit.Location = impactPoint;
+			outHit.ImpactNormal = normal;
+			outHit.Normal = normal;
+			return true;
+		}
+
+		if(coord == endCoord || cellExit > traceLength) { break; }
+
+		const auto axis = nextBoundary.X <= nextBoundary.Y ? (nextBoundary.X <= nextBoundary.Z ? 0 : 2) : (nextBoundary.Y <= nextBoundary.Z ? 1 : 2);
+		coord[axis] += step[axis];
+		cellEnter = static_cast<float>(nextBoundary[axis]);
+		nextBoundary[axis] += boundaryStep[axis];
+	}
+
+	return false;
+}
+
+bool AClimbSurfaceIndex::SweepCapsule(const FVector& start, const FVector& end, float radius, float halfHeight, TArray<FHitResult>& outHits) const {
+	// climb sweeps are near zero length, so test the capsule at its end pose and fold cells into one hit per surface class
+	const auto segmentHalf = FVector(0.f, 0.f, FMath::Max(halfHeight - radius, 0.f));
+	const auto segmentStart = end - segmentHalf;
+	const auto segmentEnd = end + segmentHalf;
+	const auto reach = radius + CellSize * 0.5f;
+	const auto backFaceSlack = CellSize * PlaneHitSlack;
+	const auto extent = FVector(radius, radius, halfHeight);
+	const auto minCoord = ToCellCoord(end - extent);
+	const auto maxCoord = ToCellCoord(end + extent);
+
+	FHitResult walkableHit(start, end);
+	FHitResult wallHit(start, end);
+	FVector walkableLocationSum = FVector::ZeroVector, walkableNormalSum = FVector::ZeroVector;
+	FVector wallLocationSum = FVector::ZeroVector, wallNormalSum = FVector::ZeroVector;
+	auto walkableCount = 0, wallCount = 0;
+
+	for(auto x = minCoord.X; x <= maxCoord.X; ++x) {
+		for(auto y = minCoord.Y; y <= maxCoord.Y; ++y) {
+			for(auto z = minCoord.Z; z <= maxCoord.Z; ++z) {
+				const auto coord = FIntVector(x, y, z);
+				for(const auto& face : FindCellFaces(coord)) {
+					// the face's patch of surface has to be beside the capsule and its plane within the radius
+					const auto surfacePoint = face.ProjectOntoSurface(ToCellCenter(coord));
+					const auto closest = FMath::ClosestPointOnSegment(surfacePoint, segmentStart, segmentEnd);
+					if(FVector::DistSquared(surfacePoint, closest) > FMath::Square(reach)) { continue; }
+
+					// an axis well behind the face is on the far side of the geometry, e.g. the back of a thin wall
+					const auto normal = FVector(face.Normal);
+					const auto planeDistance = FVector::DotProduct(normal, closest) - face.PlaneDistance;
+					if(planeDistance > radius || planeDistance < -backFaceSlack) { continue; }
+
+					// the contact is the point of the plane nearest the capsule axis, where a physics sweep would report it
+					const auto contact = closest - normal * planeDistance;
+					if(face.HasAnyFlags(EClimbSurfaceCellFlags::Walkable)) {
+						walkableLocationSum += contact;
+						walkableNormalSum += normal;
+						++walkableCount;
+					} else {
+						wallLocationSum += contact;
+						wallNormalSum += normal;
+						++wallCount;
+					}
+				}
+			}
+		}
+	}
+
+	if(wallCount > 0) {
+		FillAggregateHit(wallHit, wallLocationSum / wallCount, wallNormalSum.GetSafeNormal());
+		outHits.Add(wallHit);
+	}
+	if(walkableCount > 0) {
+		FillAggregateHit(walkableHit, walkableLocationSum / walkableCount, walkableNormalSum.GetSafeNormal());
+		outHits.Add(walkableHit);
+	}
+
+	return wallCount > 0 || walkableCount > 0;
+}
+
+bool AClimbSurfaceIndex::HasCellWithFlagsInBox(const FBox& box, EClimbSurfaceCellFlags inFlags) const {
+	const auto minCoord = ToCellCoord(box.Min);
+	const auto maxCoord = ToCellCoord(box.Max);
+
+	for(auto x = minCoord.X; x <= maxCoord.X; ++x) {
+		for(auto y = minCoord.Y; y <= maxCoord.Y; ++y) {
+			for(auto z = minCoord.Z; z <= maxCoord.Z; ++z) {
+				if(CellHasAnyFlags(FIntVector(x, y, z), inFlags)) { return true; }
+			}
+		}
+	}
+
+	return false;
+}
+
+#if WITH_EDITOR
+void AClimbSurfaceIndex::Bake() {
+	auto* world = GetWorld();
+	if(!world) { return; }
+
+	Modify();
+
+	const FCollisionObjectQueryParams objectQueryParams(SurfaceTraceTypes);
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(ClimbSurfaceIndexBake), false);
+	queryParams.MobilityType = EQueryMobilityType::Static;
+
+	// gather the static geometry the climb traces can see, movable geometry is always traced live
+	auto bounds = BakeBounds;
+	for(TActorIterator<AActor> it(world); it; ++it) {
+		if(*it == this) { continue; }
+
+		it->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* component) {
+			if(!component->IsCollisionEnabled()) { return; }
+			if(!(objectQueryParams.GetQueryBitfield() & ECC_TO_BITFIELD(component->GetCollisionObjectType()))) { return; }
+
+			if(component->Mobility == EComponentMobility::Static && !BakeBounds.IsValid) {
+				bounds += component->Bounds.GetBox();
+			}
+		});
+	}
+
+	Cells.Reset();
+	if(!bounds.IsValid) {
+		UE_LOG(LogClimbing, Warning, TEXT("%s: nothing to bake"), *GetName());
+		return;
+	}
+
+	bounds = bounds.ExpandBy(CellSize);
+	const auto size = bounds.GetSize();
+	const auto gridCount = FIntVector(
+		FMath::CeilToInt(size.X / CellSize),
+		FMath::CeilToInt(size.Y / CellSize),
+		FMath::CeilToInt(size.Z / CellSize));
+
+	const auto numRays = 2 * (static_cast<int64>(gridCount.Y) * gridCount.Z +
+	                          static_cast<int64>(gridCount.X) * gridCount.Z +
+	                          static_cast<int64>(gridCount.X) * gridCount.Y);
+	if(numRays > MaxBakeRays) {
+		UE_LOG(LogClimbing, Warning, TEXT("%s: bake needs %lld rays, over the MaxBakeRays limit of %d"), *GetName(), numRays, MaxBakeRays);
+		return;
+	}
+
+	// averaging every sample of a cell would cancel the two sides of a thin wall and chamfer edges, so samples are
+	// grouped into one plane per face instead
+	struct FFaceAccumulator {
+		FVector NormalSum = FVector::ZeroVector;
+		FVector PointSum = FVector::ZeroVector;
+		int32 NumPoints = 0;
+	};
+	TMap<uint64, TArray<FFaceAccumulator, TInlineAllocator<2>>> accumulators;
+	TArray<FHitResult> hits;
+
+	// cast rays along both directions of every axis so each face of the geometry gets sampled
+	for(auto axis = 0; axis < 3; ++axis) {
+		const auto u = (axis + 1) % 3;
+		const auto v = (axis + 2) % 3;
+		for(auto i = 0; i < gridCount[u]; ++i) {
+			for(auto j = 0; j < gridCount[v]; ++j) {
+				FVector rayStart = bounds.Min;
+				rayStart[u] += (i + 0.5f) * CellSize;
+				rayStart[v] += (j + 0.5f) * CellSize;
+				FVector rayEnd = rayStart;
+				rayEnd[axis] = bounds.Max[axis];
+
+				for(auto direction = 0; direction < 2; ++direction) {
+					const auto& from = direction == 0 ? rayStart : rayEnd;
+					const auto& to = direction == 0 ? rayEnd : rayStart;
+					world->LineTraceMultiByObjectType(hits, from, to, objectQueryParams, queryParams);
+
+					for(const auto& hit : hits) {
+						if(hit.ImpactNormal.IsNearlyZero()) { continue; }
+
+						auto& faces = accumulators.FindOrAdd(PackCellKey(ToCellCoord(hit.ImpactPoint)));
+						auto* face = faces.FindByPredicate([&hit](const FFaceAccumulator& candidate) {
+							return FVector::DotProduct(candidate.NormalSum.GetSafeNormal(), hit.ImpactNormal) >= FaceClusterMinNormalDot;
+						});
+						if(!face) {
+							face = &faces.AddDefaulted_GetRef();
+						}
+						face->NormalSum += hit.ImpactNormal;
+						face->PointSum += hit.ImpactPoint;
+						++face->NumPoints;
+					}
+				}
+			}
+		}
+	}
+
+	Cells.Reserve(accumulators.Num());
+	for(const auto& [key, faces] : accumulators) {
+		for(const auto& face : faces) {
+			const auto normal = face.NormalSum.GetSafeNormal();
+			if(normal.IsZero()) { continue; }
+
+			FClimbSurfaceCell& cell = Cells.AddDefaulted_GetRef();
+			cell.Key = key;
+			cell.Normal = FVector3f(normal);
+			cell.PlaneDistance = FVector::DotProduct(normal, face.PointSum / face.NumPoints);
+			cell.Flags = static_cast<uint8>(cell.Normal.Z >= WalkableMinNormalZ ? EClimbSurfaceCellFlags::Walkable : EClimbSurfaceCellFlags::Climbable);
+		}
+	}
+	// stable, so the faces of a cell stay in bake order next to each other
+	Cells.StableSort([](const FClimbSurfaceCell& a, const FClimbSurfaceCell& b) { return a.Key < b.Key; });
+
+	// derive ledge and vault markers from the neighbourhood once the base cells are searchable
+	const auto vaultCells = FMath::CeilToInt(VaultMaxObstacleHeight / CellSize);
+	for(auto& cell : Cells) {
+		const auto coord = UnpackCellKey(cell.Key);
+
+		if(cell.HasAnyFlags(EClimbSurfaceCellFlags::Climbable)) {
+			if(CellHasAnyFlags(coord + FIntVector(0, 0, 1), EClimbSurfaceCellFlags::Climbable)) { continue; }
+
+			for(auto dx = -1; dx <= 1; ++dx) {
+				for(auto dy = -1; dy <= 1; ++dy) {
+					if(CellHasAnyFlags(coord + FIntVector(dx, dy, 1), EClimbSurfaceCellFlags::Walkable) ||
+					   CellHasAnyFlags(coord + FIntVector(dx, dy, 0), EClimbSurfaceCellFlags::Walkable)) {
+						cell.Flags |= static_cast<uint8>(EClimbSurfaceCellFlags::LedgeEdge);
+					}
+				}
+			}
+			continue;
+		}
+
+		// a walkable top with clear space above and another floor a short drop below is something to vault over
+		if(!FindCellFaces(coord + FIntVector(0, 0, 1)).IsEmpty() || !FindCellFaces(coord + FIntVector(0, 0, 2)).IsEmpty()) { continue; }
+		for(auto dz = 2; dz <= vaultCells + 1; ++dz) {
+			for(auto dx = -1; dx <= 1; dx += 2) {
+				if(CellHasAnyFlags(coord + FIntVector(dx, 0, -dz), EClimbSurfaceCellFlags::Walkable) ||
+				   CellHasAnyFlags(coord + FIntVector(0, dx, -dz), EClimbSurfaceCellFlags::Walkable)) {
+					cell.Flags |= static_cast<uint8>(EClimbSurfaceCellFlags::Vaultable);
+				}
+			}
+		}
+	}
+
+	BakeVersion = FaceClusterBakeVersion;
+	UE_LOG(LogClimbing, Log, TEXT("%s: baked %d faces in %d cells from %lld rays"), *GetName(), Cells.Num(), accumulators.Num(), numRays);
+}
+#endif
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Climbing/ClimbingStats.h"
+
+DEFINE_STAT(STAT_Climb_PhysClimb);
+DEFINE_STAT(STAT_Climb_TraceClimbableSurfaces);
+DEFINE_STAT(STAT_Climb_CheckHasReachedFloor);
+DEFINE_STAT(STAT_Climb_LedgeDetected);
+DEFINE_STAT(STAT_Climb_CanStartVaulting);
+DEFINE_STAT(STAT_Climb_CheckCanHopUp);
+DEFINE_STAT(STAT_Climb_CheckCanHopDown);
+DEFINE_STAT(STAT_Climb_OnClimbMontageEnded);
+DEFINE_STAT(STAT_Climb_MassSurfaceQuery);
+DEFINE_STAT(STAT_Climb_MassMovement);
+DEFINE_STAT(STAT_Climb_QueryBatch);
+DEFINE_STAT(STAT_Climb_NavGraphSearch);
+DEFINE_STAT(STAT_Climb_LimbIK);
+
+DEFINE_STAT(STAT_Climb_NumClimbers);
+DEFINE_STAT(STAT_Climb_SceneQueries);
+DEFINE_STAT(STAT_Climb_IndexQueries);
+DEFINE_STAT(STAT_Climb_QueryHits);
+DEFINE_STAT(STAT_Climb_MaxClimberSceneQueries);
+DEFINE_STAT(STAT_Climb_BatchedQueryRequests);
+DEFINE_STAT(STAT_Climb_BatchedUniqueQueries);
+DEFINE_STAT(STAT_Climb_CandidateResolves);
+DEFINE_STAT(STAT_Climb_CandidateFallbacks);
+DEFINE_STAT(STAT_Climb_MontageFallbacks);
+DEFINE_STAT(STAT_Climb_ServerMoveBits);
+DEFINE_STAT(STAT_Climb_ClientCorrections);
+
+CSV_DEFINE_CATEGORY_MODULE(CLIMBINGSYSTEM_API, Climbing, true);
@@ -2,46 +2,185 @@
 
 
 #include "Components/CustomMovementComponent.h"
-#include "Kismet/KismetSystemLibrary.h"
 #include "ClimbingSystem/ClimbingSystemCharacter.h"
 #include "Components/CapsuleComponent.h"
 #include "ClimbingSystem/DebugHelper.h"
+#include "Debug/ClimbLog.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "ClimbingSystem/ClimbingSystemCharacter.h"
 #include "MotionWarpingComponent.h"
+#include "Climbing/ClimbSurfaceIndex.h"
+#include "Climbing/ClimbMath.h"
+#include "Climbing/ClimbingStats.h"
+#include "Climbing/ClimbRootMotionCache.h"
+#include "Animation/AnimMontage.h"
+#include "Climbing/ClimbRootMotionSource.h"
+#include "Climbing/ClimbQuerySubsystem.h"
+#include "Debug/ClimbDebugDrawSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Misc/ScopeExit.h"
+#include "Net/UnrealNetwork.h"
+
+namespace {
+	// sized for the handful of components a climb capsule overlaps, buffers only grow past this on unusually busy walls
+	constexpr int32 ClimbTraceHitReserve = 16;
+	// surface, floor and two ledge queries, a full set of candidate probes and one trace per limb in flight at once
+	constexpr int32 AsyncTraceSlotReserve = 32;
+	// the world only keeps async results for the frame after they were issued, slots older than this were abandoned
+	constexpr uint64 AsyncTraceSlotMaxAge = 2;
+	// normal changes below this are noise from the snap, not worth a property update
+	constexpr float ClimbNormalReplicationTolerance = 0.01f;
+
+	// candidate probe slots, on the wall
+	constexpr int32 CandidateHopUp = 0;
+	constexpr int32 CandidateHopUpLedge = 1;
+	constexpr int32 CandidateHopDown = 2;
+	// and off it, the vault profile and landing probes follow CandidateVaultStart
+	constexpr int32 CandidateSurface = 0;
+	constexpr int32 CandidateEye = 1;
+	constexpr int32 CandidateClimbDownWalkable = 2;
+	constexpr int32 CandidateClimbDownLedge = 3;
+	constexpr int32 CandidateVaultStart = 4;
+}
+
+UCustomMovementComponent::UCustomMovementComponent() {
+	SetIsReplicatedByDefault(true);
+}
+
+void UCustomMovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UCustomMovementComponent, replicatedClimbSurfaceNormal, COND_SimulatedOnly);
+}
+
+FNetworkPredictionData_Client* UCustomMovementComponent::GetPredictionData_Client() const {
+	if(!ClientPredictionData) {
+		auto* mutableThis = const_cast<UCustomMovementComponent*>(this);
+		mutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Climb(*this);
+	}
+
+	return ClientPredictionData;
+}
 
 void UCustomMovementComponent::BeginPlay() {
 	Super::BeginPlay();
-	owningPlayerAnimInstance = CharacterOwner->GetMesh()->GetAnimInstance();
+	InitClimbQueryParams();
+	FindSurfaceIndex();
+
+	// dedicated servers may run climbers without a mesh or anim instance, they fall back to the baked curves
+	owningPlayerAnimInstance = CharacterOwner->GetMesh() ? CharacterOwner->GetMesh()->GetAnimInstance() : nullptr;
 	if(owningPlayerAnimInstance) {
 		owningPlayerAnimInstance->OnMontageEnded.AddDynamic(this, &UCustomMovementComponent::onClimbMontageEnded);
 		owningPlayerAnimInstance->OnMontageBlendingOut.AddDynamic(this, &UCustomMovementComponent::onClimbMontageEnded);
+		defaultRootMotionMode = owningPlayerAnimInstance->RootMotionMode;
 	}
 
 	playerChar = Cast<AClimbingSystemCharacter>(CharacterOwner);
+	standCapsuleHalfHeight = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+
+	if(bUseClimbQuerySubsystem) {
+		querySubsystem = GetWorld()->GetSubsystem<UClimbQuerySubsystem>();
+		if(querySubsystem.IsValid()) {
+			querySubsystem->RegisterClimber(this);
+		}
+	}
+
+	if(!bStreamClimbMontages && NeedsClimbMontages()) {
+		RequestClimbMontages();
+	}
+
+	budgetedMesh = Cast<USkeletalMeshComponentBudgeted>(CharacterOwner->GetMesh());
+	if(budgetedMesh.IsValid()) {
+		budgetedMesh->OnReduceWork().BindUObject(this, &UCustomMovementComponent::OnAnimationReduceWork);
+		UpdateClimbAnimationBudget(true);
+	}
+}
+
+void UCustomMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if(querySubsystem.IsValid()) {
+		querySubsystem->UnregisterClimber(this);
+	}
+	querySubsystem = nullptr;
+	ReleaseClimbMontages();
+
+	if(budgetedMesh.IsValid()) {
+		budgetedMesh->OnReduceWork().Unbind();
+	}
+	budgetedMesh = nullptr;
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UCustomMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	UpdateClimbLOD();
+	ConsumeClimbCandidates();
+	ConsumeClimbLimbIK();
+	TickCapsuleMorph(DeltaTime);
+
+#if STATS && CLIMB_PERF_COUNTERS
+	const auto sceneQueriesBeforeTick = perfCounters.NumSceneQueries;
+#endif
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	UpdateClimbLimbIK(DeltaTime);
+	UpdateClimbAnimationBudget();
+	PublishAnimSnapshot();
+	UpdateClimbMontageStreaming();
+
+	if(ShouldRequestClimbCandidates()) {
+		RequestClimbCandidates();
+	}
+
+	// PhysClimb runs once per substep and again for every replayed move, count each climber once per tick instead
+	if(IsClimbing()) {
+		INC_DWORD_STAT(STAT_Climb_NumClimbers);
+	}
+
+	if(IsClimbing() && CharacterOwner && CharacterOwner->HasAuthority() &&
+	   !replicatedClimbSurfaceNormal.Equals(currentClimbableSurfaceNormal, ClimbNormalReplicationTolerance)) {
+		replicatedClimbSurfaceNormal = currentClimbableSurfaceNormal;
+	}
+
+#if STATS && CLIMB_PERF_COUNTERS
+	// climbers tick on the game thread, so a frame-stamped static is enough to track the worst one
+	static uint64 maxQueriesFrame = 0;
+	static uint32 maxQueriesThisFrame = 0;
+	if(maxQueriesFrame != GFrameCounter) {
+		maxQueriesFrame = GFrameCounter;
+		maxQueriesThisFrame = 0;
+	}
+	maxQueriesThisFrame = FMath::Max(maxQueriesThisFrame, perfCounters.NumSceneQueries - sceneQueriesBeforeTick);
+	SET_DWORD_STAT(STAT_Climb_MaxClimberSceneQueries, maxQueriesThisFrame);
+#endif
 }
 
 void UCustomMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) {
+	InvalidateSurfaceCache();
+	InvalidateClimbCandidates();
+	ResetClimbLimbIK();
+	climbLODTickCounter = 0;
+
 	if(IsClimbing()) {
 		bOrientRotationToMovement = false;
-		CharacterOwner->GetCapsuleComponent()->SetCapsuleHalfHeight(48.f);
+		BeginCapsuleMorph(ClimbCapsuleHalfHeight, false);
 
+		CLIMB_LOG(Verbose, TEXT("%s entered climbing"), *GetNameSafe(CharacterOwner));
 		OnEnterClimbStateDelegate.ExecuteIfBound();
 	}
 
 	if(PreviousMovementMode == MOVE_Custom && PreviousCustomMode == ECustomMovementMode::MOVE_Climb) {
+		ResetAsyncClimbQueries();
 		bOrientRotationToMovement = true;
-		CharacterOwner->GetCapsuleComponent()->SetCapsuleHalfHeight(96.f);
-
-		const FRotator DirtyRotation = UpdatedComponent->GetComponentRotation();
-		const FRotator CleanStandRotation = FRotator(0.f, DirtyRotation.Yaw, 0.f);
-		UpdatedComponent->SetRelativeRotation(CleanStandRotation);
+		// the capsule grows and levels out over the next frames under one deferred overlap update each, not three in a row here
+		BeginCapsuleMorph(standCapsuleHalfHeight, true);
 		StopMovementImmediately();
 
+		CLIMB_LOG(Verbose, TEXT("%s stopped climbing"), *GetNameSafe(CharacterOwner));
 		OnExitClimbStateDelegate.ExecuteIfBound();
 	}
 
@@ -73,58 +212,1081 @@ float UCustomMovementComponent::GetMaxAcceleration() const {
 }
 
 FVector UCustomMovementComponent::ConstrainAnimRootMotionVelocity(const FVector& RootMotionVelocity, const FVector& CurrentVelocity) const {
-	if(IsFalling() && owningPlayerAnimInstance && owningPlayerAnimInstance->IsAnyMontagePlaying()) {
+	if(IsFalling() && IsClimbActionPlaying()) {
 		return RootMotionVelocity;
 	}
 
 	return Super::ConstrainAnimRootMotionVelocity(RootMotionVelocity, CurrentVelocity);
 }
 
+void UCustomMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds) {
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+	ProcessClimbRequests();
+}
+
+void UCustomMovementComponent::UpdateCharacterStateAfterMovement(float DeltaSeconds) {
+	Super::UpdateCharacterStateAfterMovement(DeltaSeconds);
+	CheckBakedRootMotionFinished();
+}
+
+void UCustomMovementComponent::UpdateFromCompressedFlags(uint8 Flags) {
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToClimb = (Flags & FSavedMove_Climb::FLAG_Climb) != 0;
+	bWantsToStopClimbing = (Flags & FSavedMove_Climb::FLAG_StopClimb) != 0;
+	bWantsToHop = (Flags & FSavedMove_Climb::FLAG_Hop) != 0;
+	bWantsToVault = (Flags & FSavedMove_Climb::FLAG_Vault) != 0;
+}
+
+bool UCustomMovementComponent::ClientUpdatePositionAfterServerUpdate() {
+	// each replayed move runs the requests it was saved with, the ones made since the last move go out with the next one
+	const auto bRealWantsToClimb = bWantsToClimb;
+	const auto bRealWantsToStopClimbing = bWantsToStopClimbing;
+	const auto bRealWantsToHop = bWantsToHop;
+	const auto bRealWantsToVault = bWantsToVault;
+
+	const auto bResult = Super::ClientUpdatePositionAfterServerUpdate();
+
+	bWantsToClimb = bRealWantsToClimb;
+	bWantsToStopClimbing = bRealWantsToStopClimbing;
+	bWantsToHop = bRealWantsToHop;
+	bWantsToVault = bRealWantsToVault;
+	return bResult;
+}
+
+void UCustomMovementComponent::ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits& PackedBits) {
+	CLIMB_PERF_COUNT(perfCounters, NumServerMoveBits, PackedBits.DataBits.Num());
+	INC_DWORD_STAT_BY(STAT_Climb_ServerMoveBits, PackedBits.DataBits.Num());
+	Super::ServerMovePacked_ClientSend(PackedBits);
+}
+
+void UCustomMovementComponent::ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse) {
+	if(!MoveResponse.IsGoodMove()) {
+		CLIMB_PERF_COUNT(perfCounters, NumClientCorrections, 1);
+		INC_DWORD_STAT(STAT_Climb_ClientCorrections);
+	}
+	Super::ClientHandleMoveResponse(MoveResponse);
+}
+
 #pragma region ClimbTraces
-TArray<FHitResult> UCustomMovementComponent::DoCapsuleTraceMultiByObject(const FVector& start, const FVector& end, bool bShowDebugShape, bool bDrawPersistentShapes) {
-	TArray<FHitResult> outCapsuleTraceHitResults;
+void UCustomMovementComponent::InitClimbQueryParams() {
+	climbQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(ClimbTrace), false);
+	climbObjectQueryParams = FCollisionObjectQueryParams(ClimableSurfaceTraceTypes);
+
+	climbDynamicQueryParams = climbQueryParams;
+	climbDynamicQueryParams.MobilityType = EQueryMobilityType::Dynamic;
+
+	climableSurfacesTracedResults.Reserve(ClimbTraceHitReserve);
+	floorTracedResults.Reserve(ClimbTraceHitReserve);
+	dynamicTracedResults.Reserve(ClimbTraceHitReserve);
+	asyncFloorHits.Reserve(ClimbTraceHitReserve);
+	asyncLedgeHits.Reserve(ClimbTraceHitReserve);
+	candidateHits.Reserve(ClimbTraceHitReserve);
+	limbIKHits.Reserve(ClimbTraceHitReserve);
+
+	asyncTraceDelegate.BindUObject(this, &UCustomMovementComponent::OnAsyncTraceDone);
+	asyncTraceSlots.Reset();
+	asyncTraceSlots.Reserve(AsyncTraceSlotReserve);
+}
+
+void UCustomMovementComponent::FindSurfaceIndex() {
+	surfaceIndex = nullptr;
+	if(!bUseBakedSurfaceIndex) { return; }
 
-	auto debugTraceType = EDrawDebugTrace::None;
-	if(bShowDebugShape) {
-		debugTraceType = bDrawPersistentShapes ? EDrawDebugTrace::Persistent : EDrawDebugTrace::ForOneFrame;
+	for(TActorIterator<AClimbSurfaceIndex> it(GetWorld()); it; ++it) {
+		if(it->IsBaked()) {
+			surfaceIndex = *it;
+			return;
+		}
 	}
-	UKismetSystemLibrary::CapsuleTraceMultiForObjects(
-		this,
-		start,
-		end,
-		ClimbCapsuleTraceRadius,
-		ClimbCapsuleTraceHalfHeight,
-		ClimableSurfaceTraceTypes,
-		false,
-		TArray<AActor*>(),
-		debugTraceType,
-		outCapsuleTraceHitResults,
-		false
-	);
+}
+
+bool UCustomMovementComponent::ShouldUseAsyncClimbQueries() const {
+	// index lookups are already cheaper than a deferred physics query
+	return bUseAsyncClimbQueries && !surfaceIndex.IsValid() && !ShouldUseBatchedClimbQueries();
+}
+
+bool UCustomMovementComponent::ShouldUseBatchedClimbQueries() const {
+	return bUseClimbQuerySubsystem && !surfaceIndex.IsValid() && querySubsystem.IsValid();
+}
 
-	return outCapsuleTraceHitResults;
+bool UCustomMovementComponent::DoCapsuleTraceMultiByObject(const FVector& start, const FVector& end, TArray<FHitResult>& outHits, EClimbDebugCategory debugCategory, bool bShowDebugShape, bool bDrawPersistentShapes) {
+	outHits.Reset();
+	const auto capsuleShape = FCollisionShape::MakeCapsule(ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight);
+
+	if(const auto* index = surfaceIndex.Get()) {
+		index->SweepCapsule(start, end, ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight, outHits);
+		CLIMB_PERF_COUNT(perfCounters, NumIndexQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_IndexQueries);
+		// the index only holds static geometry, anything movable can be spawned or streamed in after the bake
+		GetWorld()->SweepMultiByObjectType(dynamicTracedResults, start, end, FQuat::Identity, climbObjectQueryParams, capsuleShape, climbDynamicQueryParams);
+		CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_SceneQueries);
+		outHits.Append(dynamicTracedResults);
+	} else {
+		GetWorld()->SweepMultiByObjectType(outHits, start, end, FQuat::Identity, climbObjectQueryParams, capsuleShape, climbQueryParams);
+		CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_SceneQueries);
+	}
+	CLIMB_PERF_COUNT(perfCounters, NumHits, outHits.Num());
+	INC_DWORD_STAT_BY(STAT_Climb_QueryHits, outHits.Num());
+
+#if CLIMB_DEBUG_DRAW
+	// persistent requests become timed shapes so they cannot pile up in the line batcher
+	auto* debugDraw = (bShowDebugShape || UClimbDebugDrawSubsystem::IsCategoryEnabled(debugCategory)) ? UClimbDebugDrawSubsystem::Get(GetWorld()) : nullptr;
+	if(debugDraw) {
+		debugDraw->AddCapsule(start, ClimbCapsuleTraceHalfHeight, ClimbCapsuleTraceRadius, FColor::Red, bDrawPersistentShapes);
+		debugDraw->AddCapsule(end, ClimbCapsuleTraceHalfHeight, ClimbCapsuleTraceRadius, FColor::Red, bDrawPersistentShapes);
+		for(const auto& hit : outHits) {
+			debugDraw->AddPoint(hit.ImpactPoint, 16.f, FColor::Green, bDrawPersistentShapes);
+		}
+	}
+#endif
+
+	return !outHits.IsEmpty();
 }
 
-FHitResult UCustomMovementComponent::DoLineTraceSingleByObject(const FVector& start, const FVector& end, bool bShowDebugShape, bool bDrawPersistentShapes, FColor color) {
+FHitResult UCustomMovementComponent::DoLineTraceSingleByObject(const FVector& start, const FVector& end, EClimbDebugCategory debugCategory, bool bShowDebugShape, bool bDrawPersistentShapes, FColor color) {
 	FHitResult outHit;
+	if(const auto* index = surfaceIndex.Get()) {
+		index->LineTrace(start, end, outHit);
+		CLIMB_PERF_COUNT(perfCounters, NumIndexQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_IndexQueries);
+		FHitResult dynamicHit;
+		GetWorld()->LineTraceSingleByObjectType(dynamicHit, start, end, climbObjectQueryParams, climbDynamicQueryParams);
+		CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_SceneQueries);
+		if(dynamicHit.bBlockingHit && (!outHit.bBlockingHit || dynamicHit.Time < outHit.Time)) {
+			outHit = dynamicHit;
+		}
+	} else {
+		GetWorld()->LineTraceSingleByObjectType(outHit, start, end, climbObjectQueryParams, climbQueryParams);
+		CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_SceneQueries);
+	}
+	CLIMB_PERF_COUNT(perfCounters, NumHits, outHit.bBlockingHit ? 1 : 0);
+	INC_DWORD_STAT_BY(STAT_Climb_QueryHits, outHit.bBlockingHit ? 1 : 0);
+
+#if CLIMB_DEBUG_DRAW
+	auto* debugDraw = (bShowDebugShape || UClimbDebugDrawSubsystem::IsCategoryEnabled(debugCategory)) ? UClimbDebugDrawSubsystem::Get(GetWorld()) : nullptr;
+	if(debugDraw) {
+		debugDraw->AddLine(start, outHit.bBlockingHit ? outHit.ImpactPoint : end, color, bDrawPersistentShapes);
+		if(outHit.bBlockingHit) {
+			debugDraw->AddPoint(outHit.ImpactPoint, 16.f, FColor::Green, bDrawPersistentShapes);
+		}
+	}
+#endif
+
+	return outHit;
+}
+#pragma endregion
+
+#pragma region ClimbBakedRootMotion
+bool UCustomMovementComponent::ShouldUseBakedRootMotion() const {
+	if(!RootMotionCache) { return false; }
+
+	// montage root motion with motion warping cannot be reproduced exactly by the curve's warp approximation, so a
+	// predicted player has to use the curve on both its owning client and the server or every action gets corrected
+	const auto bNetworkPredicted = CharacterOwner->GetLocalRole() == ROLE_AutonomousProxy ||
+		(CharacterOwner->GetLocalRole() == ROLE_Authority && CharacterOwner->IsPlayerControlled() && !CharacterOwner->IsLocallyControlled());
+
+	return bAlwaysUseBakedRootMotion || !owningPlayerAnimInstance || bNetworkPredicted || CharacterOwner->IsNetMode(NM_DedicatedServer);
+}
+
+bool UCustomMovementComponent::NeedsClimbMontages() const {
+	return !ShouldUseBakedRootMotion() || (owningPlayerAnimInstance && !CharacterOwner->IsNetMode(NM_DedicatedServer));
+}
+
+#if WITH_EDITOR
+FClimbNavTraversalParams UCustomMovementComponent::GetNavTraversalParams() const {
+	const auto getDuration = [this](const TSoftObjectPtr<UAnimMontage>& montage) {
+		if(montage.IsNull()) { return 0.f; }
+
+		const auto* curve = RootMotionCache ? RootMotionCache->Find(FName(*montage.GetAssetName())) : nullptr;
+		if(curve && curve->IsValid()) { return curve->Duration; }
+
+		const auto* loaded = montage.LoadSynchronous();
+		return loaded ? loaded->GetPlayLength() / FMath::Max(loaded->RateScale, UE_KINDA_SMALL_NUMBER) : 0.f;
+	};
+
+	FClimbNavTraversalParams params;
+	params.ClimbSpeed = MaxClimbSpeed;
+	params.HopUpReach = ClimbHopUpReach;
+	params.HopDownReach = ClimbHopDownReach;
+	params.VaultLandClearance = VaultLandClearance;
+	params.StartClimbingDuration = getDuration(IdleToClimbMontage);
+	params.HopUpDuration = getDuration(HopUpMontage);
+	params.HopDownDuration = getDuration(HopDownMontage);
+	params.ClimbUpDuration = getDuration(ClimbToTopMontage);
+	params.ClimbDownDuration = getDuration(ClimbDownLedgeMontage);
+	params.VaultDuration = getDuration(VaultMontage);
+	return params;
+}
+#endif
+
+bool UCustomMovementComponent::PlayBakedRootMotion(const TSoftObjectPtr<UAnimMontage>& montage) {
+	// curves are keyed by asset name, so the montage itself never has to be loaded
+	const auto curveName = FName(*montage.GetAssetName());
+	const auto* curve = RootMotionCache->Find(curveName);
+	if(!curve || !curve->IsValid()) {
+		CLIMB_LOG_RATE_LIMITED(Warning, RootMotionCache, 10.f, TEXT("%s: no baked root motion for %s"), *GetNameSafe(RootMotionCache), *curveName.ToString());
+		return false;
+	}
+
+	const auto actorQuat = UpdatedComponent->GetComponentQuat();
+	auto source = MakeShared<FRootMotionSource_ClimbCurve>();
+	source->InstanceName = curveName;
+	source->Duration = curve->Duration;
+	source->Cache = RootMotionCache;
+	source->CurveName = curveName;
+	source->StartLocation = UpdatedComponent->GetComponentLocation();
+	source->CurveToWorld = actorQuat * CharacterOwner->GetBaseRotationOffset();
+	// warp targets are where the mesh root lands, the curve moves the capsule
+	source->InitWarpOffsets(*curve, motionWarpTargets, -actorQuat.RotateVector(CharacterOwner->GetBaseTranslationOffset()));
+
+	bakedRootMotionSourceID = ApplyRootMotionSource(source);
+	bakedRootMotionMontage = montage;
+	return bakedRootMotionSourceID != 0;
+}
+
+void UCustomMovementComponent::PlayCosmeticClimbMontage(const TSoftObjectPtr<UAnimMontage>& montage) {
+	if(!owningPlayerAnimInstance || CharacterOwner->IsNetMode(NM_DedicatedServer)) { return; }
+
+	// not streamed in yet, moving unanimated for one action beats a hitch
+	auto* loadedMontage = montage.Get();
+	if(!loadedMontage) { return; }
+
+	bClimbMontagesCosmetic = true;
+	owningPlayerAnimInstance->SetRootMotionMode(ERootMotionMode::IgnoreRootMotion);
+	owningPlayerAnimInstance->Montage_Play(loadedMontage);
+	UpdateClimbAnimationBudget(true);
+}
+
+void UCustomMovementComponent::CheckBakedRootMotionFinished() {
+	if(bakedRootMotionSourceID == 0) { return; }
 
-	auto debugTraceType = EDrawDebugTrace::None;
-	if(bShowDebugShape) {
-		debugTraceType = bDrawPersistentShapes ? EDrawDebugTrace::Persistent : EDrawDebugTrace::ForOneFrame;
+	const auto source = GetRootMotionSourceByID(bakedRootMotionSourceID);
+	if(source.IsValid() && !source->Status.HasFlag(ERootMotionSourceStatusFlags::Finished)) { return; }
+
+	// clear first, the transition may start the next climb action
+	const auto finishedMontage = bakedRootMotionMontage;
+	bakedRootMotionSourceID = 0;
+	bakedRootMotionMontage.Reset();
+	onClimbActionFinished(finishedMontage);
+}
+#pragma endregion
+
+#pragma region ClimbNetworking
+void UCustomMovementComponent::ProcessClimbRequests() {
+	// a correction replay rewinds to the server's state, so the requests of unacknowledged moves run again here.
+	// Only their montages are skipped, see playClimbMontage.
+	if(bWantsToStopClimbing && IsClimbing()) {
+		stopClimbing();
+	} else if(bWantsToClimb && !IsClimbing()) {
+		TryStartClimbing();
+	}
+
+	if(bWantsToVault && !IsClimbing()) {
+		TryStartVaulting();
+	}
+
+	if(bWantsToHop && IsClimbing()) {
+		HandleHopping();
+	}
+
+	bWantsToClimb = false;
+	bWantsToStopClimbing = false;
+	bWantsToHop = false;
+	bWantsToVault = false;
+}
+
+void UCustomMovementComponent::OnRep_ClimbSurfaceNormal() {
+	if(!CharacterOwner || CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy) { return; }
+
+	currentClimbableSurfaceNormal = replicatedClimbSurfaceNormal;
+	targetClimbableSurfaceNormal = replicatedClimbSurfaceNormal;
+}
+#pragma endregion
+
+#pragma region ClimbLOD
+void UCustomMovementComponent::UpdateClimbLOD() {
+	if(!bEnableClimbLOD || !IsClimbing()) {
+		SetClimbLOD(EClimbLOD::Full);
+		return;
 	}
-	UKismetSystemLibrary::LineTraceSingleForObjects(
-		this,
+
+	const auto now = GetWorld()->GetTimeSeconds();
+	if(now - lastClimbLODEvaluationTime < ClimbLODEvaluationInterval) { return; }
+	lastClimbLODEvaluationTime = now;
+
+	// climbers driven by a local player always run at full fidelity
+	UpdateClimbViewerDistance();
+	if(climbViewerDistance == 0.f) {
+		SetClimbLOD(EClimbLOD::Full);
+		return;
+	}
+
+	auto effectiveDistance = climbViewerDistance;
+	if(GetNetMode() != NM_DedicatedServer && !CharacterOwner->WasRecentlyRendered(ClimbLODEvaluationInterval)) {
+		effectiveDistance *= ClimbLODHiddenDistanceScale;
+	}
+
+	// bias each threshold toward the level we are already at so climbers on a boundary do not flicker
+	const auto reducedDistance = ClimbLODReducedDistance + (currentClimbLOD >= EClimbLOD::Reduced ? -ClimbLODHysteresis : ClimbLODHysteresis);
+	const auto minimalDistance = ClimbLODMinimalDistance + (currentClimbLOD >= EClimbLOD::Minimal ? -ClimbLODHysteresis : ClimbLODHysteresis);
+
+	if(effectiveDistance >= minimalDistance) {
+		SetClimbLOD(EClimbLOD::Minimal);
+	} else if(effectiveDistance >= reducedDistance) {
+		SetClimbLOD(EClimbLOD::Reduced);
+	} else {
+		SetClimbLOD(EClimbLOD::Full);
+	}
+}
+
+void UCustomMovementComponent::UpdateClimbViewerDistance() {
+	if(CharacterOwner->IsLocallyControlled() && CharacterOwner->IsPlayerControlled()) {
+		climbViewerDistance = 0.f;
+		return;
+	}
+
+	const auto location = UpdatedComponent->GetComponentLocation();
+	auto closestDistanceSquared = TNumericLimits<float>::Max();
+	for(auto it = GetWorld()->GetPlayerControllerIterator(); it; ++it) {
+		const auto* playerController = it->Get();
+		if(!playerController || !playerController->PlayerCameraManager) { continue; }
+
+		closestDistanceSquared = FMath::Min<float>(closestDistanceSquared, FVector::DistSquared(location, playerController->PlayerCameraManager->GetCameraLocation()));
+	}
+	climbViewerDistance = FMath::Sqrt(closestDistanceSquared);
+}
+
+void UCustomMovementComponent::SetClimbLOD(EClimbLOD newLOD) {
+	if(newLOD == currentClimbLOD) { return; }
+
+	currentClimbLOD = newLOD;
+	bClimbLODBlending = true;
+	climbLODTickCounter = 0;
+}
+
+int32 UCustomMovementComponent::GetClimbLODSurfaceInterval() const {
+	switch(currentClimbLOD) {
+		case EClimbLOD::Reduced: return ClimbLODReducedSurfaceInterval;
+		case EClimbLOD::Minimal: return ClimbLODMinimalSurfaceInterval;
+		default: return 1;
+	}
+}
+
+int32 UCustomMovementComponent::GetClimbLODProbeInterval() const {
+	switch(currentClimbLOD) {
+		case EClimbLOD::Reduced: return ClimbLODReducedProbeInterval;
+		case EClimbLOD::Minimal: return ClimbLODMinimalProbeInterval;
+		default: return 1;
+	}
+}
+
+bool UCustomMovementComponent::IsClimbLODRefreshTick(int32 interval, uint32 ticksAhead) const {
+	return interval <= 1 || (climbLODTickCounter + ticksAhead) % interval == 1;
+}
+#pragma endregion
+
+#pragma region ClimbSurfaceCache
+bool UCustomMovementComponent::CanReuseSurfaceCache() const {
+	if(!bUseSurfaceCache || !surfaceCache.bValid || !IsClimbing()) { return false; }
+	if(surfaceCache.TicksSinceRefresh >= SurfaceCacheForcedRefreshTicks) { return false; }
+
+	if(FVector::DistSquared(UpdatedComponent->GetComponentLocation(), surfaceCache.Location) > FMath::Square(SurfaceCacheMaxLocationDelta)) {
+		return false;
+	}
+
+	if(UpdatedComponent->GetComponentQuat().AngularDistance(surfaceCache.Rotation) > FMath::DegreesToRadians(SurfaceCacheMaxRotationDelta)) {
+		return false;
+	}
+
+	for(const auto& [component, transform] : surfaceCache.HitComponents) {
+		if(!component.IsValid()) { return false; }
+		if(component->Mobility != EComponentMobility::Static &&
+		   !component->GetComponentTransform().Equals(transform, KINDA_SMALL_NUMBER)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UCustomMovementComponent::StoreSurfaceCache(const FVector& location, const FQuat& rotation) {
+	surfaceCache.Location = location;
+	surfaceCache.Rotation = rotation;
+	surfaceCache.TicksSinceRefresh = 0;
+	surfaceCache.HitComponents.Reset();
+
+	for(const auto& hit : climableSurfacesTracedResults) {
+		auto* component = hit.GetComponent();
+		if(!component) { continue; }
+
+		const bool bAlreadyCached = surfaceCache.HitComponents.ContainsByPredicate([component](const auto& entry) {
+			return entry.Key == component;
+		});
+		if(!bAlreadyCached) {
+			surfaceCache.HitComponents.Emplace(component, component->GetComponentTransform());
+		}
+	}
+
+	surfaceCache.bValid = true;
+}
+
+void UCustomMovementComponent::InvalidateSurfaceCache() {
+	surfaceCache.bValid = false;
+	surfaceCache.HitComponents.Reset();
+}
+
+float UCustomMovementComponent::GetSurfaceCacheHitRate() const {
+	const auto total = surfaceCacheHits + surfaceCacheMisses;
+	return total > 0 ? static_cast<float>(surfaceCacheHits) / total : 0.f;
+}
+#pragma endregion
+
+#pragma region ClimbAsyncQueries
+void UCustomMovementComponent::RequestAsyncClimbQueries() {
+	FVector start, end;
+	if(CanReuseSurfaceCache()) {
+		++surfaceCacheHits;
+		++surfaceCache.TicksSinceRefresh;
+	} else {
+		GetClimbableSurfaceTraceSegment(start, end);
+		asyncSurfaceTraceHandle = RequestAsyncCapsuleTrace(start, end);
+		asyncSurfaceRequestLocation = UpdatedComponent->GetComponentLocation();
+		asyncSurfaceRequestRotation = UpdatedComponent->GetComponentQuat();
+	}
+
+	GetFloorTraceSegment(start, end);
+	asyncFloorTraceHandle = RequestAsyncCapsuleTrace(start, end);
+
+	// the ledge probe normally only traces down when the eye trace misses, both ends are known up front so batch them together
+	GetEyeHeightTraceSegment(100.f, 50.f, start, end);
+	asyncLedgeEyeTraceHandle = RequestAsyncLineTrace(start, end);
+	asyncLedgeDownTraceHandle = RequestAsyncLineTrace(end, end - UpdatedComponent->GetUpVector() * 100.f);
+}
+
+bool UCustomMovementComponent::ConsumeAsyncClimbQueries() {
+	// the floor sweep goes out every batch, the surface sweep is skipped while the cache holds
+	if(!ConsumeAsyncTrace(asyncFloorTraceHandle, asyncFloorHits)) {
+		ResetAsyncClimbQueries();
+		return false;
+	}
+
+	if(asyncSurfaceTraceHandle.IsValid()) {
+		if(!ConsumeAsyncTrace(asyncSurfaceTraceHandle, climableSurfacesTracedResults)) {
+			ResetAsyncClimbQueries();
+			return false;
+		}
+		++surfaceCacheMisses;
+		StoreSurfaceCache(asyncSurfaceRequestLocation, asyncSurfaceRequestRotation);
+	}
+
+	ConsumeAsyncTrace(asyncLedgeEyeTraceHandle, asyncLedgeHits);
+	const bool bEyeBlocked = asyncLedgeHits.ContainsByPredicate([](const FHitResult& hit) { return hit.bBlockingHit; });
+
+	ConsumeAsyncTrace(asyncLedgeDownTraceHandle, asyncLedgeHits);
+	const bool bDownBlocked = asyncLedgeHits.ContainsByPredicate([](const FHitResult& hit) { return hit.bBlockingHit; });
+
+	bAsyncLedgeDetected = !bEyeBlocked && bDownBlocked;
+	return true;
+}
+
+void UCustomMovementComponent::ResetAsyncClimbQueries() {
+	asyncSurfaceTraceHandle = FTraceHandle();
+	asyncFloorTraceHandle = FTraceHandle();
+	asyncLedgeEyeTraceHandle = FTraceHandle();
+	asyncLedgeDownTraceHandle = FTraceHandle();
+	asyncFloorHits.Reset();
+	asyncLedgeHits.Reset();
+	bAsyncLedgeDetected = false;
+}
+
+FTraceHandle UCustomMovementComponent::RequestAsyncCapsuleTrace(const FVector& start, const FVector& end) {
+	CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+	INC_DWORD_STAT(STAT_Climb_SceneQueries);
+	return ClaimAsyncTraceSlot(GetWorld()->AsyncSweepByObjectType(
+		EAsyncTraceType::Multi,
 		start,
 		end,
-		ClimableSurfaceTraceTypes,
-		false,
-		TArray<AActor*>(),
-		debugTraceType,
-		outHit,
-		false,
-		color
-	);
-	return outHit;
+		FQuat::Identity,
+		climbObjectQueryParams,
+		FCollisionShape::MakeCapsule(ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight),
+		climbQueryParams,
+		&asyncTraceDelegate
+	));
+}
+
+FTraceHandle UCustomMovementComponent::RequestAsyncLineTrace(const FVector& start, const FVector& end) {
+	CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+	INC_DWORD_STAT(STAT_Climb_SceneQueries);
+	return ClaimAsyncTraceSlot(GetWorld()->AsyncLineTraceByObjectType(
+		EAsyncTraceType::Single,
+		start,
+		end,
+		climbObjectQueryParams,
+		climbQueryParams,
+		&asyncTraceDelegate
+	));
+}
+
+FTraceHandle UCustomMovementComponent::ClaimAsyncTraceSlot(const FTraceHandle& handle) {
+	// slots and their hit buffers are recycled, so once the busiest tick has been seen nothing here allocates
+	auto* slot = asyncTraceSlots.FindByPredicate([](const FClimbAsyncTraceSlot& s) {
+		return !s.Handle.IsValid() || GFrameCounter - s.IssuedFrame > AsyncTraceSlotMaxAge;
+	});
+	if(!slot) {
+		slot = &asyncTraceSlots.AddDefaulted_GetRef();
+		slot->Hits.Reserve(ClimbTraceHitReserve);
+	}
+	slot->Handle = handle;
+	slot->IssuedFrame = GFrameCounter;
+	slot->bDone = false;
+	return handle;
+}
+
+void UCustomMovementComponent::OnAsyncTraceDone(const FTraceHandle& handle, FTraceDatum& traceData) {
+	auto* slot = asyncTraceSlots.FindByPredicate([&handle](const FClimbAsyncTraceSlot& s) { return s.Handle == handle; });
+	if(!slot) { return; }
+
+	// the datum stays owned by the world, its hits are copied into the slot's reserved buffer
+	slot->Hits.Reset();
+	slot->Hits.Append(traceData.OutHits);
+	slot->bDone = true;
+}
+
+bool UCustomMovementComponent::ConsumeAsyncTrace(FTraceHandle& handle, TArray<FHitResult>& outHits) {
+	outHits.Reset();
+	if(!handle.IsValid()) { return false; }
+
+	auto* slot = asyncTraceSlots.FindByPredicate([&handle](const FClimbAsyncTraceSlot& s) { return s.Handle == handle; });
+	handle = FTraceHandle();
+	if(!slot) { return false; }
+
+	// the slot is free again either way, a trace that has not finished is dropped as QueryTraceData used to drop it
+	slot->Handle = FTraceHandle();
+	if(!slot->bDone) { return false; }
+
+	outHits.Append(slot->Hits);
+	CLIMB_PERF_COUNT(perfCounters, NumHits, outHits.Num());
+	INC_DWORD_STAT_BY(STAT_Climb_QueryHits, outHits.Num());
+	return true;
+}
+#pragma endregion
+
+#pragma region ClimbMontageStreaming
+void UCustomMovementComponent::UpdateClimbMontageStreaming() {
+	// the baked curves stand in for every montage and nobody sees this one animate, nothing to load
+	if(!bStreamClimbMontages || !UpdatedComponent || !NeedsClimbMontages()) { return; }
+
+	const auto now = GetWorld()->GetTimeSeconds();
+	if(lastMontageStreamingCheckTime >= 0.f && now - lastMontageStreamingCheckTime < ClimbMontageStreamingInterval) { return; }
+	lastMontageStreamingCheckTime = now;
+
+	if(IsClimbing() || IsClimbActionPlaying() || IsNearClimbableGeometry(ClimbMontagePreloadRadius, EClimbSurfaceCellFlags::Climbable | EClimbSurfaceCellFlags::Vaultable)) {
+		lastNearClimbableTime = now;
+		RequestClimbMontages();
+	} else if(climbMontageHandle.IsValid() && now - lastNearClimbableTime > ClimbMontageReleaseDelay) {
+		ReleaseClimbMontages();
+	}
+}
+
+bool UCustomMovementComponent::IsNearClimbableGeometry(float radius, EClimbSurfaceCellFlags indexFlags) {
+	const auto location = UpdatedComponent->GetComponentLocation();
+	if(const auto* index = surfaceIndex.Get()) {
+		CLIMB_PERF_COUNT(perfCounters, NumIndexQueries, 1);
+		INC_DWORD_STAT(STAT_Climb_IndexQueries);
+		if(index->HasCellWithFlagsInBox(FBox::BuildAABB(location, FVector(radius)), indexFlags)) { return true; }
+	}
+
+	CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+	INC_DWORD_STAT(STAT_Climb_SceneQueries);
+	return GetWorld()->OverlapAnyTestByObjectType(location, FQuat::Identity, climbObjectQueryParams, FCollisionShape::MakeSphere(radius),
+		surfaceIndex.IsValid() ? climbDynamicQueryParams : climbQueryParams);
+}
+
+void UCustomMovementComponent::RequestClimbMontages() {
+	if(climbMontageHandle.IsValid()) { return; }
+
+	TArray<FSoftObjectPath> montagePaths;
+	for(const auto* montage : { &IdleToClimbMontage, &ClimbToTopMontage, &ClimbDownLedgeMontage, &VaultMontage, &HopUpMontage, &HopDownMontage }) {
+		if(!montage->IsNull()) {
+			montagePaths.AddUnique(montage->ToSoftObjectPath());
+		}
+	}
+	if(montagePaths.IsEmpty()) { return; }
+
+	CLIMB_LOG(Verbose, TEXT("%s: streaming in %d climb montages"), *GetNameSafe(CharacterOwner), montagePaths.Num());
+	climbMontageHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(montagePaths), FStreamableDelegate(),
+		FStreamableManager::DefaultAsyncLoadPriority, false, false, TEXT("ClimbMontages"));
+}
+
+void UCustomMovementComponent::ReleaseClimbMontages() {
+	if(!climbMontageHandle.IsValid()) { return; }
+
+	// a montage still playing stays referenced by its anim instance until it ends
+	CLIMB_LOG(Verbose, TEXT("%s: releasing climb montages"), *GetNameSafe(CharacterOwner));
+	climbMontageHandle->ReleaseHandle();
+	climbMontageHandle.Reset();
+}
+#pragma endregion
+
+#pragma region ClimbCapsuleMorph
+void UCustomMovementComponent::BeginCapsuleMorph(float targetHalfHeight, bool bLevelOut) {
+	const auto* capsule = CharacterOwner->GetCapsuleComponent();
+	capsuleMorphStartHalfHeight = capsule->GetUnscaledCapsuleHalfHeight();
+	capsuleMorphTargetHalfHeight = targetHalfHeight;
+	capsuleMorphStartRotation = UpdatedComponent->GetComponentRotation();
+	capsuleMorphAlpha = 0.f;
+	bCapsuleMorphLevelsOut = bLevelOut;
+	bCapsuleMorphing = true;
+
+	if(CapsuleMorphDuration <= 0.f) {
+		TickCapsuleMorph(0.f);
+	}
+}
+
+void UCustomMovementComponent::TickCapsuleMorph(float deltaTime) {
+	if(!bCapsuleMorphing || !CharacterOwner || !UpdatedComponent) { return; }
+
+	auto* capsule = CharacterOwner->GetCapsuleComponent();
+	FScopedMovementUpdate scopedUpdate(UpdatedComponent, EScopedUpdate::DeferredUpdates);
+
+	const auto alpha = CapsuleMorphDuration > 0.f ? FMath::Min(1.f, capsuleMorphAlpha + deltaTime / CapsuleMorphDuration) : 1.f;
+	const auto halfHeight = FMath::Lerp(capsuleMorphStartHalfHeight, capsuleMorphTargetHalfHeight, alpha);
+
+	// growing can push the capsule into whatever is above or below it, hold at the current height until there is room
+	if(halfHeight > capsule->GetUnscaledCapsuleHalfHeight()) {
+		const auto currentLocation = UpdatedComponent->GetComponentLocation();
+		auto location = currentLocation;
+		if(!FindUnencroachedCapsuleLocation(halfHeight, location)) {
+			CLIMB_LOG_RATE_LIMITED(VeryVerbose, CharacterOwner, 0.5f, TEXT("%s has no room to grow its capsule to %.1f"), *GetNameSafe(CharacterOwner), halfHeight);
+			return;
+		}
+		if(!location.Equals(currentLocation)) {
+			UpdatedComponent->SetWorldLocation(location, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+
+	capsuleMorphAlpha = alpha;
+	capsule->SetCapsuleHalfHeight(halfHeight, false);
+
+	if(bCapsuleMorphLevelsOut) {
+		// only pitch and roll ease back, yaw is left to whatever movement mode took over
+		const auto rotation = UpdatedComponent->GetComponentRotation();
+		const FRotator leveled(FMath::Lerp(capsuleMorphStartRotation.Pitch, 0.f, alpha), rotation.Yaw, FMath::Lerp(capsuleMorphStartRotation.Roll, 0.f, alpha));
+		UpdatedComponent->SetWorldRotation(leveled);
+	}
+
+	if(alpha >= 1.f) {
+		bCapsuleMorphing = false;
+		// the only overlap refresh of the whole morph, it lands when the scope closes
+		capsule->UpdateOverlaps();
+	}
+}
+
+bool UCustomMovementComponent::FindUnencroachedCapsuleLocation(float halfHeight, FVector& inOutLocation) const {
+	const auto* capsule = CharacterOwner->GetCapsuleComponent();
+	const auto scaledHalfHeight = halfHeight * capsule->GetShapeScale();
+	const auto growth = scaledHalfHeight - capsule->GetScaledCapsuleHalfHeight();
+	const auto shape = FCollisionShape::MakeCapsule(capsule->GetScaledCapsuleRadius(), scaledHalfHeight);
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(ClimbCapsuleMorph), false, CharacterOwner);
+	FCollisionResponseParams responseParams;
+	InitCollisionParams(queryParams, responseParams);
+
+	// centred first, then with the feet kept where they are, then with the head kept where it is
+	const auto up = UpdatedComponent->GetUpVector();
+	for(const auto offset : { 0.f, growth, -growth }) {
+		const auto candidate = inOutLocation + up * offset;
+		INC_DWORD_STAT(STAT_Climb_SceneQueries);
+		if(!GetWorld()->OverlapBlockingTestByChannel(candidate, UpdatedComponent->GetComponentQuat(), UpdatedComponent->GetCollisionObjectType(), shape, queryParams, responseParams)) {
+			inOutLocation = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+#pragma endregion
+
+#pragma region ClimbCandidates
+bool UCustomMovementComponent::ShouldRequestClimbCandidates() {
+	// only the local player resolves input from candidates, the server keeps tracing on the spot so it stays authoritative
+	if(!bUseClimbActionCandidates || !UpdatedComponent || !CharacterOwner || !CharacterOwner->IsLocallyControlled()) { return false; }
+	if(IsFalling() || IsClimbActionPlaying()) { return false; }
+
+	const auto now = GetWorld()->GetTimeSeconds();
+	if(now - lastCandidateRequestTime < ClimbCandidateRefreshInterval) { return false; }
+
+	// one proximity query instead of a full round of probes that could not hit anything, on the wall there is always something near
+	if(!IsClimbing() && !IsNearClimbableGeometry(ClimbCandidateProximityRadius,
+	   EClimbSurfaceCellFlags::Climbable | EClimbSurfaceCellFlags::Vaultable | EClimbSurfaceCellFlags::LedgeEdge)) {
+		lastCandidateRequestTime = now;
+		return false;
+	}
+
+	return true;
+}
+
+void UCustomMovementComponent::RequestClimbCandidates() {
+	candidateTraceHandles.Reset();
+	pendingCandidates = FClimbActionCandidates();
+	pendingCandidates.Location = UpdatedComponent->GetComponentLocation();
+	pendingCandidates.Rotation = UpdatedComponent->GetComponentQuat();
+	pendingCandidates.EvaluationTime = GetWorld()->GetTimeSeconds();
+	pendingCandidates.bClimbing = IsClimbing();
+	lastCandidateRequestTime = pendingCandidates.EvaluationTime;
+
+	// the index answers on the spot, so the candidates come straight from the checks the actions would otherwise run
+	if(surfaceIndex.IsValid()) {
+		EvaluateClimbCandidates(pendingCandidates);
+		climbCandidates = pendingCandidates;
+		return;
+	}
+
+	// the same probes CheckCanHopUp and CheckCanHopDown trace
+	FVector start, end;
+	if(pendingCandidates.bClimbing) {
+		GetEyeHeightTraceSegment(100.f, -10.f, start, end);
+		candidateTraceHandles.Add(RequestAsyncLineTrace(start, end));
+		GetEyeHeightTraceSegment(100.f, ClimbHopUpReach, start, end);
+		candidateTraceHandles.Add(RequestAsyncLineTrace(start, end));
+		GetEyeHeightTraceSegment(100.f, -ClimbHopDownReach, start, end);
+		candidateTraceHandles.Add(RequestAsyncLineTrace(start, end));
+		return;
+	}
+
+	// CanStartClimbing, then CanClimbDown
+	GetClimbableSurfaceTraceSegment(start, end);
+	candidateTraceHandles.Add(RequestAsyncCapsuleTrace(start, end));
+	GetEyeHeightTraceSegment(100.f, 0.f, start, end);
+	candidateTraceHandles.Add(RequestAsyncLineTrace(start, end));
+
+	const auto forward = UpdatedComponent->GetForwardVector();
+	const auto down = -UpdatedComponent->GetUpVector();
+	const auto walkableStart = pendingCandidates.Location + forward * ClimbDownWalkableSurfaceForwardTraceOffset;
+	candidateTraceHandles.Add(RequestAsyncLineTrace(walkableStart, walkableStart + down * 100.f));
+	const auto ledgeStart = walkableStart + forward * ClimbDownLedgeForwardTraceOffset;
+	candidateTraceHandles.Add(RequestAsyncLineTrace(ledgeStart, ledgeStart + down * 200.f));
+
+	// CanStartVaulting walks the obstacle one probe at a time, here every profile sample and every landing spot it could pick go out together
+	const auto probeOrigin = pendingCandidates.Location + UpdatedComponent->GetUpVector() * VaultProbeHeight;
+	auto addVaultProbe = [&](float forwardOffset, float depth) {
+		const auto probeStart = probeOrigin + forward * forwardOffset;
+		candidateTraceHandles.Add(RequestAsyncLineTrace(probeStart, probeStart + down * depth));
+	};
+
+	addVaultProbe(VaultStartForwardOffset, VaultStartTraceDepth);
+	for(auto i = 1; i <= VaultProfileSamples; ++i) {
+		addVaultProbe(VaultStartForwardOffset + VaultProfileSpacing * i, VaultStartTraceDepth);
+	}
+	if(VaultProfileSamples == 0) {
+		addVaultProbe(VaultLandForwardOffset, VaultLandTraceDepth);
+	}
+	for(auto i = 1; i <= VaultProfileSamples; ++i) {
+		addVaultProbe(VaultStartForwardOffset + VaultProfileSpacing * i + VaultLandClearance, VaultLandTraceDepth);
+	}
+}
+
+void UCustomMovementComponent::EvaluateClimbCandidates(FClimbActionCandidates& candidates) {
+	if(candidates.bClimbing) {
+		candidates.bCanHopUp = CheckCanHopUp(candidates.HopUpTarget);
+		candidates.bCanHopDown = CheckCanHopDown(candidates.HopDownTarget);
+		return;
+	}
+
+	candidates.bCanStartClimbing = CanStartClimbing();
+	candidates.bCanClimbDown = CanClimbDown();
+	candidates.bCanVault = CanStartVaulting(candidates.VaultStart, candidates.VaultLand);
+}
+
+void UCustomMovementComponent::ConsumeClimbCandidates() {
+	if(candidateTraceHandles.IsEmpty()) { return; }
+
+	// every handle is consumed even after one comes back empty, a partial set is thrown away as a whole
+	auto candidates = pendingCandidates;
+	auto bComplete = true;
+	auto consume = [&](int32 index) {
+		FHitResult hit;
+		bComplete &= ConsumeCandidateTrace(index, hit);
+		return hit;
+	};
+
+	if(candidates.bClimbing) {
+		const auto hopUpHit = consume(CandidateHopUp);
+		const auto hopUpLedgeHit = consume(CandidateHopUpLedge);
+		const auto hopDownHit = consume(CandidateHopDown);
+
+		candidates.bCanHopUp = hopUpHit.bBlockingHit && hopUpLedgeHit.bBlockingHit;
+		candidates.HopUpTarget = hopUpHit.ImpactPoint;
+		candidates.bCanHopDown = hopDownHit.bBlockingHit;
+		candidates.HopDownTarget = hopDownHit.ImpactPoint;
+	} else {
+		const auto surfaceHit = consume(CandidateSurface);
+		const auto eyeHit = consume(CandidateEye);
+		candidates.bCanStartClimbing = surfaceHit.bBlockingHit && eyeHit.bBlockingHit;
+
+		const auto walkableHit = consume(CandidateClimbDownWalkable);
+		const auto ledgeHit = consume(CandidateClimbDownLedge);
+		candidates.bCanClimbDown = walkableHit.bBlockingHit && !ledgeHit.bBlockingHit;
+
+		const auto startHit = consume(CandidateVaultStart);
+		TArray<FHitResult, TInlineAllocator<16>> vaultHits;
+		for(auto i = CandidateVaultStart + 1; i < candidateTraceHandles.Num(); ++i) {
+			vaultHits.Add(consume(i));
+		}
+
+		// same edge search as CanStartVaulting, over hits that are already in
+		auto landIndex = 0;
+		auto bFoundLanding = VaultProfileSamples == 0;
+		for(auto i = 0; i < VaultProfileSamples && !bFoundLanding; ++i) {
+			const auto& sampleHit = vaultHits[i];
+			if(!sampleHit.bBlockingHit || FMath::Abs(sampleHit.ImpactPoint.Z - startHit.ImpactPoint.Z) > VaultProfileHeightTolerance) {
+				landIndex = VaultProfileSamples + i;
+				bFoundLanding = true;
+			}
+		}
+
+		if(startHit.bBlockingHit && bFoundLanding && vaultHits.IsValidIndex(landIndex) && vaultHits[landIndex].bBlockingHit) {
+			candidates.bCanVault = true;
+			candidates.VaultStart = startHit.ImpactPoint;
+			candidates.VaultLand = vaultHits[landIndex].ImpactPoint;
+		}
+	}
+
+	candidateTraceHandles.Reset();
+	if(bComplete) {
+		climbCandidates = candidates;
+	}
+}
+
+void UCustomMovementComponent::InvalidateClimbCandidates() {
+	climbCandidates.EvaluationTime = -1.f;
+	candidateTraceHandles.Reset();
+}
+
+const FClimbActionCandidates* UCustomMovementComponent::GetFreshClimbCandidates() const {
+	if(!bUseClimbActionCandidates) { return nullptr; }
+
+	const bool bFresh = climbCandidates.EvaluationTime >= 0.f &&
+		climbCandidates.bClimbing == IsClimbing() &&
+		GetWorld()->GetTimeSeconds() - climbCandidates.EvaluationTime <= ClimbCandidateMaxAge &&
+		FVector::DistSquared(climbCandidates.Location, UpdatedComponent->GetComponentLocation()) <= FMath::Square(ClimbCandidateMaxDrift) &&
+		climbCandidates.Rotation.AngularDistance(UpdatedComponent->GetComponentQuat()) <= FMath::DegreesToRadians(ClimbCandidateMaxTurn);
+
+	if(!bFresh) {
+		INC_DWORD_STAT(STAT_Climb_CandidateFallbacks);
+		return nullptr;
+	}
+	INC_DWORD_STAT(STAT_Climb_CandidateResolves);
+	return &climbCandidates;
+}
+
+bool UCustomMovementComponent::ConsumeCandidateTrace(int32 index, FHitResult& outHit) {
+	outHit = FHitResult();
+	if(!ConsumeAsyncTrace(candidateTraceHandles[index], candidateHits)) { return false; }
+
+	// object queries report every hit as blocking, the first one is what the single traces would have returned
+	if(!candidateHits.IsEmpty()) {
+		outHit = candidateHits[0];
+	}
+	return true;
+}
+#pragma endregion
+
+#pragma region ClimbAnimationBudget
+void UCustomMovementComponent::UpdateClimbAnimationBudget(bool bForce) {
+	auto* mesh = budgetedMesh.Get();
+	if(!mesh || !UpdatedComponent) { return; }
+
+	// a montage transition is only finished once onClimbMontageEnded runs, so it has to tick every frame even off screen
+	const auto bProtected = owningPlayerAnimInstance && owningPlayerAnimInstance->IsAnyMontagePlaying();
+	const auto now = GetWorld()->GetTimeSeconds();
+	if(!bForce && bProtected == bAnimationBudgetProtected && lastAnimationBudgetUpdateTime >= 0.f && now - lastAnimationBudgetUpdateTime < ClimbLODEvaluationInterval) { return; }
+	lastAnimationBudgetUpdateTime = now;
+	bAnimationBudgetProtected = bProtected;
+
+	// UpdateClimbLOD keeps the distance fresh on the wall, off it nothing else does
+	if(!bEnableClimbLOD || !IsClimbing()) {
+		UpdateClimbViewerDistance();
+	}
+
+	const auto bLocalPlayer = CharacterOwner->IsLocallyControlled() && CharacterOwner->IsPlayerControlled();
+	const auto significance = 1.f / (1.f + climbViewerDistance / ClimbAnimationSignificanceFalloff);
+	mesh->SetComponentSignificance(significance, bLocalPlayer || bProtected, bProtected, !bLocalPlayer && !bProtected);
+}
+
+void UCustomMovementComponent::OnAnimationReduceWork(USkeletalMeshComponentBudgeted* component, bool bReduce) {
+	bAnimationWorkReduced = bReduce;
+}
+#pragma endregion
+
+#pragma region ClimbLimbIK
+void UCustomMovementComponent::GetLimbIKTraceSegment(EClimbLimb limb, FVector& outStart, FVector& outEnd) const {
+	const auto bHand = limb == EClimbLimb::LeftHand || limb == EClimbLimb::RightHand;
+	const auto bLeft = limb == EClimbLimb::LeftHand || limb == EClimbLimb::LeftFoot;
+	const auto& offset = bHand ? ClimbHandIKOffset : ClimbFootIKOffset;
+
+	outStart = UpdatedComponent->GetComponentLocation() +
+		UpdatedComponent->GetRightVector() * (bLeft ? -offset.X : offset.X) +
+		UpdatedComponent->GetUpVector() * offset.Y;
+	outEnd = outStart + UpdatedComponent->GetForwardVector() * ClimbLimbIKTraceDistance;
+}
+
+void UCustomMovementComponent::RequestClimbLimbIK() {
+	const auto now = GetWorld()->GetTimeSeconds();
+	if(lastLimbIKRequestTime >= 0.f && now - lastLimbIKRequestTime < ClimbLimbIKRefreshInterval) { return; }
+	lastLimbIKRequestTime = now;
+
+	constexpr auto numLimbs = static_cast<int32>(EClimbLimb::Num);
+	const auto budget = FMath::Min(ClimbLimbIKMaxTracesPerTick, numLimbs);
+	auto issued = 0;
+	for(auto checked = 0; checked < numLimbs && issued < budget; ++checked) {
+		const auto limb = static_cast<EClimbLimb>(nextLimbIKTrace);
+		auto& state = limbIKStates[nextLimbIKTrace];
+		nextLimbIKTrace = (nextLimbIKTrace + 1) % numLimbs;
+		if(state.TraceHandle.IsValid()) { continue; }
+
+		FVector start, end;
+		GetLimbIKTraceSegment(limb, start, end);
+		state.TraceHandle = RequestAsyncLineTrace(start, end);
+		++issued;
+	}
+}
+
+void UCustomMovementComponent::ConsumeClimbLimbIK() {
+	for(auto& state : limbIKStates) {
+		if(!state.TraceHandle.IsValid()) { continue; }
+		// no data means the trace was dropped, the previous surface is still the best guess
+		if(!ConsumeAsyncTrace(state.TraceHandle, limbIKHits)) { continue; }
+
+		const auto* hit = limbIKHits.FindByPredicate([](const FHitResult& h) { return h.bBlockingHit; });
+		auto* component = hit ? hit->GetComponent() : nullptr;
+		state.bHasSurface = component != nullptr;
+		if(!component) { continue; }
+
+		const auto& componentTransform = component->GetComponentTransform();
+		state.Component = component;
+		state.LocalPoint = componentTransform.InverseTransformPosition(hit->ImpactPoint);
+		state.LocalNormal = componentTransform.InverseTransformVectorNoScale(hit->ImpactNormal);
+	}
+}
+
+void UCustomMovementComponent::UpdateClimbLimbIK(float deltaTime) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_LimbIK, UpdateClimbLimbIK);
+	// nothing to pose without an anim instance, and far climbers or an over budget frame are not worth the traces
+	const auto bActive = bEnableClimbLimbIK && owningPlayerAnimInstance && UpdatedComponent && IsClimbing() && currentClimbLOD != EClimbLOD::Minimal && !bAnimationWorkReduced;
+	// climb montages place the limbs themselves
+	const auto bApply = bActive && !IsClimbActionPlaying();
+
+	for(auto i = 0; i < static_cast<int32>(EClimbLimb::Num); ++i) {
+		const auto limb = static_cast<EClimbLimb>(i);
+		auto& state = limbIKStates[i];
+		auto& target = animSnapshot.GetLimbIK(limb);
+
+		// slide the limb's current ray onto the last traced surface, the wall under a limb rarely changes between traces
+		auto bOnSurface = false;
+		const auto* component = state.bHasSurface ? state.Component.Get() : nullptr;
+		if(bActive && component) {
+			const auto& componentTransform = component->GetComponentTransform();
+			const auto point = componentTransform.TransformPosition(state.LocalPoint);
+			const auto normal = componentTransform.TransformVectorNoScale(state.LocalNormal);
+
+			FVector start, end;
+			GetLimbIKTraceSegment(limb, start, end);
+			const auto direction = end - start;
+			const auto facing = FVector::DotProduct(direction, normal);
+			const auto t = facing < -KINDA_SMALL_NUMBER ? FVector::DotProduct(point - start, normal) / facing : -1.f;
+			if(t >= 0.f && t <= 1.f) {
+				target.Location = start + direction * t;
+				target.Normal = normal;
+				bOnSurface = true;
+			}
+		}
+
+		// the last target is kept while blending out so the limb does not snap
+		state.Alpha = FMath::FInterpConstantTo(state.Alpha, bApply && bOnSurface ? 1.f : 0.f, deltaTime, ClimbLimbIKBlendSpeed);
+		target.Alpha = state.Alpha;
+	}
+
+	if(bActive) {
+		RequestClimbLimbIK();
+	}
+}
+
+void UCustomMovementComponent::ResetClimbLimbIK() {
+	// alphas are left to blend out on their own
+	for(auto& state : limbIKStates) {
+		state.TraceHandle = FTraceHandle();
+		state.Component = nullptr;
+		state.bHasSurface = false;
+	}
+	lastLimbIKRequestTime = -1.f;
+}
+#pragma endregion
+
+#pragma region ClimbBatchedQueries
+void UCustomMovementComponent::GatherBatchedClimbQueries(UClimbQuerySubsystem& batch) {
+	batchedQueryBatch = 0;
+	// PhysClimb bumps the LOD counter before it tests it, so look one tick ahead
+	if(!ShouldUseBatchedClimbQueries() || !IsClimbing() || !IsClimbLODRefreshTick(GetClimbLODSurfaceInterval(), 1)) { return; }
+
+	const auto capsuleShape = FCollisionShape::MakeCapsule(ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight);
+	FVector start, end;
+	batchedSurfaceQuery = INDEX_NONE;
+	if(CanReuseSurfaceCache()) {
+		++surfaceCacheHits;
+		++surfaceCache.TicksSinceRefresh;
+	} else {
+		GetClimbableSurfaceTraceSegment(start, end);
+		batchedSurfaceQuery = batch.AddSweep(start, end, capsuleShape, climbObjectQueryParams, climbQueryParams);
+		batchedSurfaceRequestLocation = UpdatedComponent->GetComponentLocation();
+		batchedSurfaceRequestRotation = UpdatedComponent->GetComponentQuat();
+	}
+
+	GetFloorTraceSegment(start, end);
+	batchedFloorQuery = batch.AddSweep(start, end, capsuleShape, climbObjectQueryParams, climbQueryParams);
+
+	GetEyeHeightTraceSegment(100.f, 50.f, start, end);
+	batchedLedgeEyeQuery = batch.AddLineTrace(start, end, climbObjectQueryParams, climbQueryParams);
+	batchedLedgeDownQuery = batch.AddLineTrace(end, end - UpdatedComponent->GetUpVector() * 100.f, climbObjectQueryParams, climbQueryParams);
+
+	batchedQueryBatch = batch.GetBatchNumber();
+}
+
+bool UCustomMovementComponent::ConsumeBatchedClimbQueries() {
+	// the batch ran this frame at the pose PhysClimb starts from, anything older is discarded
+	const bool bCurrent = batchedQueryBatch != 0 && querySubsystem.IsValid() && querySubsystem->GetBatchNumber() == batchedQueryBatch;
+	batchedQueryBatch = 0;
+	if(!bCurrent) { return false; }
+
+	if(batchedSurfaceQuery != INDEX_NONE) {
+		CopyBatchedHits(batchedSurfaceQuery, climableSurfacesTracedResults);
+		++surfaceCacheMisses;
+		StoreSurfaceCache(batchedSurfaceRequestLocation, batchedSurfaceRequestRotation);
+	}
+
+	CopyBatchedHits(batchedFloorQuery, asyncFloorHits);
+
+	CopyBatchedHits(batchedLedgeEyeQuery, asyncLedgeHits);
+	const bool bEyeBlocked = asyncLedgeHits.ContainsByPredicate([](const FHitResult& hit) { return hit.bBlockingHit; });
+
+	CopyBatchedHits(batchedLedgeDownQuery, asyncLedgeHits);
+	const bool bDownBlocked = asyncLedgeHits.ContainsByPredicate([](const FHitResult& hit) { return hit.bBlockingHit; });
+
+	bAsyncLedgeDetected = !bEyeBlocked && bDownBlocked;
+	return true;
+}
+
+void UCustomMovementComponent::CopyBatchedHits(int32 queryIndex, TArray<FHitResult>& outHits) {
+	outHits.Reset();
+	outHits.Append(querySubsystem->GetHits(queryIndex));
+	CLIMB_PERF_COUNT(perfCounters, NumSceneQueries, 1);
+	CLIMB_PERF_COUNT(perfCounters, NumHits, outHits.Num());
+	INC_DWORD_STAT_BY(STAT_Climb_QueryHits, outHits.Num());
 }
 #pragma endregion
 
@@ -132,21 +1294,22 @@ FHitResult UCustomMovementComponent::DoLineTraceSingleByObject(const FVector& st
 
 void UCustomMovementComponent::ToggleClimbing(bool bEnableClimb) {
 	if(bEnableClimb) {
-		if(CanStartClimbing()) { 
-			// enter climb state
-			//Debug::Print(TEXT("Can start climbing"));
-			playClimbMontage(IdleToClimbMontage);
-		} else if(CanClimbDown()) {
-			playClimbMontage(ClimbDownLedgeMontage);
-		} else {
-			TryStartVaulting();
-		}
+		bWantsToClimb = true;
+	} else {
+		bWantsToStopClimbing = true;
 	}
-	
-	if(!bEnableClimb) {
-		//Debug::Print(TEXT("cannot start climbing"));
-		//stop climbing
-		stopClimbing();
+}
+
+void UCustomMovementComponent::TryStartClimbing() {
+	const auto* candidates = GetFreshClimbCandidates();
+	if(candidates ? candidates->bCanStartClimbing && !IsFalling() : CanStartClimbing()) {
+		// enter climb state
+		playClimbMontage(IdleToClimbMontage);
+	} else if(candidates ? candidates->bCanClimbDown && !IsFalling() : CanClimbDown()) {
+		playClimbMontage(ClimbDownLedgeMontage);
+	} else {
+		CLIMB_LOG_RATE_LIMITED(VeryVerbose, CharacterOwner, 0.5f, TEXT("%s has no climb entry, trying to vault"), *GetNameSafe(CharacterOwner));
+		TryStartVaulting();
 	}
 }
 
@@ -162,91 +1325,158 @@ void UCustomMovementComponent::startClimbing() {
 	SetMovementMode(MOVE_Custom, ECustomMovementMode::MOVE_Climb);
 }
 
+void UCustomMovementComponent::EnterClimbImmediately(const FVector& inVelocity) {
+	startClimbing();
+	Velocity = inVelocity;
+}
+
 void UCustomMovementComponent::stopClimbing() {
 	SetMovementMode(MOVE_Falling);
 }
 
 void UCustomMovementComponent::PhysClimb(float deltaTime, int32 Iterations) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_PhysClimb, PhysClimb);
 	if(deltaTime < MIN_TICK_TIME) {
 		return;
 	}
-	
-	TraceClimbableSurfaces();
-	processClimbableSurfaceInfo();
 
-	if(CheckShouldStopClimbing() || CheckHasReachedFloor()) {
-		stopClimbing();
+#if CLIMB_PERF_COUNTERS
+	const auto startCycles = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT {
+		perfCounters.PhysClimbCycles += FPlatformTime::Cycles64() - startCycles;
+		++perfCounters.NumPhysClimbTicks;
+	};
+#endif
+
+	++climbLODTickCounter;
+	const bool bSurfaceRefreshTick = IsClimbLODRefreshTick(GetClimbLODSurfaceInterval());
+	const bool bProbeRefreshTick = IsClimbLODRefreshTick(GetClimbLODProbeInterval());
+
+	// async results describe last frame's pose and batched ones this frame's, fall back to blocking queries until either lands
+	const bool bHasAsyncResults = (ShouldUseBatchedClimbQueries() && ConsumeBatchedClimbQueries()) ||
+		(ShouldUseAsyncClimbQueries() && ConsumeAsyncClimbQueries());
+	if(bHasAsyncResults || bSurfaceRefreshTick) {
+		if(!bHasAsyncResults) {
+			TraceClimbableSurfaces();
+		}
+		processClimbableSurfaceInfo();
 	}
 
-	RestorePreAdditiveRootMotionVelocity();
+	const bool bReachedFloor = bHasAsyncResults ? EvaluateFloorHits(asyncFloorHits) : (bProbeRefreshTick && CheckHasReachedFloor());
 
-	if(!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity()) {
-		CalcVelocity(deltaTime, 0.f, true, MaxBreakClimbDeceleration);
-	}
+	// sub-step like walking and falling so low tick rates neither overshoot the snap nor the rotation interp
+	const bool bCanRequerySubSteps = bSurfaceRefreshTick && !ShouldUseAsyncClimbQueries() && !ShouldUseBatchedClimbQueries();
+	auto surfaceQueryLocation = UpdatedComponent->GetComponentLocation();
+	auto remainingTime = deltaTime;
+	while(remainingTime >= MIN_TICK_TIME && Iterations < MaxClimbSimulationIterations && CharacterOwner) {
+		if(!IsClimbing()) {
+			StartNewPhysics(remainingTime, Iterations);
+			return;
+		}
 
-	ApplyRootMotionToVelocity(deltaTime);
+		const bool bFirstSubStep = remainingTime == deltaTime;
+		++Iterations;
+		const auto timeTick = GetClimbSimulationTimeStep(remainingTime, Iterations);
+		remainingTime -= timeTick;
+
+		// small moves keep the frame's query, sweeping every sub-step would multiply trace cost for no visible gain
+		if(!bFirstSubStep && bCanRequerySubSteps &&
+		   FVector::DistSquared(UpdatedComponent->GetComponentLocation(), surfaceQueryLocation) > FMath::Square(ClimbSubStepRequeryDistance)) {
+			TraceClimbableSurfaces();
+			processClimbableSurfaceInfo();
+			surfaceQueryLocation = UpdatedComponent->GetComponentLocation();
+		}
+		blendClimbableSurfaceInfo(timeTick);
+
+		if(CheckShouldStopClimbing() || bReachedFloor) {
+			stopClimbing();
+			StartNewPhysics(remainingTime + timeTick, Iterations - 1);
+			return;
+		}
+
+		RestorePreAdditiveRootMotionVelocity();
+
+		if(!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity()) {
+			CalcVelocity(timeTick, 0.f, true, MaxBreakClimbDeceleration);
+		}
+
+		ApplyRootMotionToVelocity(timeTick);
 
-	FVector OldLocation = UpdatedComponent->GetComponentLocation();
-	const FVector Adjusted = Velocity * deltaTime;
-	FHitResult Hit(1.f);
-	SafeMoveUpdatedComponent(Adjusted, GetClimbRotation(deltaTime), true, Hit);
+		FVector OldLocation = UpdatedComponent->GetComponentLocation();
+		const FVector Adjusted = Velocity * timeTick;
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(Adjusted, GetClimbRotation(timeTick), true, Hit);
 
-	if(Hit.Time < 1.f) {
-		// adjust and try again
-		HandleImpact(Hit, deltaTime, Adjusted);
-		SlideAlongSurface(Adjusted, (1.f - Hit.Time), Hit.Normal, Hit, true);
+		if(Hit.Time < 1.f) {
+			// adjust and try again
+			HandleImpact(Hit, timeTick, Adjusted);
+			SlideAlongSurface(Adjusted, (1.f - Hit.Time), Hit.Normal, Hit, true);
+		}
+
+		if(!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity()) {
+			Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / timeTick;
+		}
+
+		snapMovementToSurface(timeTick);
 	}
 
-	if(!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity()) {
-		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime;
+	const bool bCheckLedge = bHasAsyncResults || bProbeRefreshTick;
+	if(IsClimbing() && bCheckLedge && (bHasAsyncResults ? bAsyncLedgeDetected : LedgeDetected()) && getUnrotatedClimbVelocity().Z > 10.f) {
+		playClimbMontage(ClimbToTopMontage);
 	}
 
-	snapMovementToSurface(deltaTime);
+	if(ShouldUseAsyncClimbQueries() && IsClimbing() && bSurfaceRefreshTick) {
+		RequestAsyncClimbQueries();
+	}
+}
 
-	if(IsClimbing() && LedgeDetected() && getUnrotatedClimbVelocity().Z > 10.f) {
-		playClimbMontage(ClimbToTopMontage);
+float UCustomMovementComponent::GetClimbSimulationTimeStep(float remainingTime, int32 Iterations) const {
+	if(remainingTime > MaxClimbSimulationTimeStep && Iterations < MaxClimbSimulationIterations) {
+		// halve rather than clamp so the frame never ends on a sliver of a step
+		remainingTime = FMath::Min(MaxClimbSimulationTimeStep, remainingTime * 0.5f);
 	}
+
+	return FMath::Max(MIN_TICK_TIME, remainingTime);
 }
 
 void UCustomMovementComponent::processClimbableSurfaceInfo() {
-	currentClimbableSurfaceLocation = FVector::ZeroVector;
-	currentClimbableSurfaceNormal = FVector::ZeroVector;
+	ClimbMath::AverageSurfaceHits(climableSurfacesTracedResults, targetClimbableSurfaceLocation, targetClimbableSurfaceNormal);
+}
 
-	if(climableSurfacesTracedResults.IsEmpty()) { return; }
+void UCustomMovementComponent::blendClimbableSurfaceInfo(float deltaTime) {
+	// full fidelity climbers snap straight to the latest query, reduced ones ease toward it between queries
+	const bool bSnap = (currentClimbLOD == EClimbLOD::Full && !bClimbLODBlending) || currentClimbableSurfaceNormal.IsZero() || targetClimbableSurfaceNormal.IsZero();
+	const auto alpha = bSnap ? 1.f : FMath::Min(1.f, deltaTime * ClimbLODSurfaceBlendSpeed);
 
-	for(const auto& hitResult : climableSurfacesTracedResults) {
-		currentClimbableSurfaceLocation += hitResult.ImpactPoint;
-		currentClimbableSurfaceNormal += hitResult.ImpactNormal;
-	}
+	currentClimbableSurfaceLocation = FMath::Lerp(currentClimbableSurfaceLocation, targetClimbableSurfaceLocation, alpha);
+	currentClimbableSurfaceNormal = FMath::Lerp(currentClimbableSurfaceNormal, targetClimbableSurfaceNormal, alpha).GetSafeNormal();
 
-	currentClimbableSurfaceLocation /= climableSurfacesTracedResults.Num();
-	currentClimbableSurfaceNormal = currentClimbableSurfaceNormal.GetSafeNormal();
+	if(bClimbLODBlending &&
+	   currentClimbableSurfaceLocation.Equals(targetClimbableSurfaceLocation, 0.1f) &&
+	   currentClimbableSurfaceNormal.Equals(targetClimbableSurfaceNormal, KINDA_SMALL_NUMBER)) {
+		bClimbLODBlending = false;
+	}
 }
 
 bool UCustomMovementComponent::CheckShouldStopClimbing() {
 	if(climableSurfacesTracedResults.IsEmpty()) { return true; }
-	auto dotResult = FVector::DotProduct(currentClimbableSurfaceNormal, FVector::UpVector);
-	auto degreeDiff = FMath::RadiansToDegrees(FMath::Acos(dotResult));
-
-	if(degreeDiff <= 60.f) {
-		return true;
-	}
 
-	//Debug::Print(TEXT("Degree Diff: ") + FString::SanitizeFloat(degreeDiff), FColor::Cyan, 1);
-	return false;
+	return ClimbMath::ShouldStopClimbing(currentClimbableSurfaceNormal);
 }
 
 bool UCustomMovementComponent::CheckHasReachedFloor() {
-	auto downVector = -UpdatedComponent->GetUpVector();
-	auto startOffset = downVector * 50.f;
-	auto start = UpdatedComponent->GetComponentLocation() + startOffset;
-	auto end = start + downVector;
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_CheckHasReachedFloor, CheckHasReachedFloor);
+	FVector start, end;
+	GetFloorTraceSegment(start, end);
 
-	auto possibleFloorHits = DoCapsuleTraceMultiByObject(start, end);
+	DoCapsuleTraceMultiByObject(start, end, floorTracedResults, EClimbDebugCategory::Floor);
+	return EvaluateFloorHits(floorTracedResults);
+}
 
-	if(possibleFloorHits.IsEmpty()) { return false; }
+bool UCustomMovementComponent::EvaluateFloorHits(const TArray<FHitResult>& floorHits) const {
+	if(floorHits.IsEmpty()) { return false; }
 
-	for(const auto& floorHit : possibleFloorHits) {
+	for(const auto& floorHit : floorHits) {
 		if(FVector::Parallel(-floorHit.ImpactNormal, FVector::UpVector) &&
 		   getUnrotatedClimbVelocity().Z < -10.f) {
 			return true;
@@ -256,13 +1486,14 @@ bool UCustomMovementComponent::CheckHasReachedFloor() {
 }
 
 bool UCustomMovementComponent::LedgeDetected() {
-	auto hitResult = TraceFromEyeHeight(100.f, 50.f);
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_LedgeDetected, LedgeDetected);
+	auto hitResult = TraceFromEyeHeight(100.f, 50.f, EClimbDebugCategory::Ledge);
 	if(!hitResult.bBlockingHit) { 
 		auto offset = -UpdatedComponent->GetUpVector() * 100.f;
 		auto startTrace = hitResult.TraceEnd;
 		auto endTrace = startTrace + offset;
 
-		return DoLineTraceSingleByObject(startTrace, endTrace).bBlockingHit;
+		return DoLineTraceSingleByObject(startTrace, endTrace, EClimbDebugCategory::Ledge).bBlockingHit;
 	}
 	return false;
 }
@@ -299,13 +1530,13 @@ bool UCustomMovementComponent::CanClimbDown() {
 	auto walkableSurfaceStart = componentLocation + componentForward * ClimbDownWalkableSurfaceForwardTraceOffset;
 	auto walkableSurfaceEnd = walkableSurfaceStart + downVec * 100.f;
 
-	auto walkableSurfaceHit = DoLineTraceSingleByObject(walkableSurfaceStart, walkableSurfaceEnd);
+	auto walkableSurfaceHit = DoLineTraceSingleByObject(walkableSurfaceStart, walkableSurfaceEnd, EClimbDebugCategory::Ledge);
 
 
 	auto ledgeStart = walkableSurfaceHit.TraceStart + componentForward * ClimbDownLedgeForwardTraceOffset;
 	auto ledgeEnd = ledgeStart + downVec * 200.f;
 
-	auto ledgeHit = DoLineTraceSingleByObject(ledgeStart, ledgeEnd);
+	auto ledgeHit = DoLineTraceSingleByObject(ledgeStart, ledgeEnd, EClimbDebugCategory::Ledge);
 
 	if(walkableSurfaceHit.bBlockingHit && !ledgeHit.bBlockingHit) {
 		return true;
@@ -316,7 +1547,16 @@ bool UCustomMovementComponent::CanClimbDown() {
 void UCustomMovementComponent::TryStartVaulting() {
 	FVector vaultStartPos;
 	FVector vaultLandPos;
-	if(CanStartVaulting(vaultStartPos, vaultLandPos)) {
+	auto bCanVault = false;
+	if(const auto* candidates = GetFreshClimbCandidates()) {
+		bCanVault = candidates->bCanVault && !IsFalling();
+		vaultStartPos = candidates->VaultStart;
+		vaultLandPos = candidates->VaultLand;
+	} else {
+		bCanVault = CanStartVaulting(vaultStartPos, vaultLandPos);
+	}
+
+	if(bCanVault) {
 		SetMotionWarpTarget(FName("VaultStart"), vaultStartPos);
 		SetMotionWarpTarget(FName("VaultEnd"), vaultLandPos);
 
@@ -326,40 +1566,46 @@ void UCustomMovementComponent::TryStartVaulting() {
 }
 
 bool UCustomMovementComponent::CanStartVaulting(FVector& outVaultStartPosition, FVector& outVaultLandPosition) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_CanStartVaulting, CanStartVaulting);
 	if(IsFalling()) { return false; }
 
 	outVaultStartPosition = FVector::ZeroVector;
 	outVaultLandPosition = FVector::ZeroVector;
 
-	auto componentLocation = UpdatedComponent->GetComponentLocation();
 	auto componentForward = UpdatedComponent->GetForwardVector();
-	auto upVector = UpdatedComponent->GetUpVector();
 	auto downVector = -UpdatedComponent->GetUpVector();
-	auto forwardAmount = 150.f;
-
-	for(auto i = 0; i < 5; ++i) {
-		auto newForward = forwardAmount;
-		if(i != 0) { newForward -= 20; }
-		auto start = componentLocation + upVector * 100.f + componentForward * newForward * (i + 1);
-		auto end = start + downVector * 100.f * (i + 1);
-
-		auto hit = DoLineTraceSingleByObject(start, end);
-
-		if(i == 0 && hit.bBlockingHit) {
-			outVaultStartPosition = hit.ImpactPoint;
+	auto probeOrigin = UpdatedComponent->GetComponentLocation() + UpdatedComponent->GetUpVector() * VaultProbeHeight;
+
+	auto startTraceStart = probeOrigin + componentForward * VaultStartForwardOffset;
+	auto startHit = DoLineTraceSingleByObject(startTraceStart, startTraceStart + downVector * VaultStartTraceDepth, EClimbDebugCategory::Vault);
+	if(!startHit.bBlockingHit) { return false; }
+
+	// walk the top of the obstacle to find its far edge, otherwise land a fixed distance ahead
+	auto landForwardOffset = VaultLandForwardOffset;
+	if(VaultProfileSamples > 0) {
+		auto bFoundEdge = false;
+		for(auto i = 1; i <= VaultProfileSamples; ++i) {
+			auto sampleForward = VaultStartForwardOffset + VaultProfileSpacing * i;
+			auto sampleStart = probeOrigin + componentForward * sampleForward;
+			auto sampleHit = DoLineTraceSingleByObject(sampleStart, sampleStart + downVector * VaultStartTraceDepth, EClimbDebugCategory::Vault);
+
+			if(!sampleHit.bBlockingHit || FMath::Abs(sampleHit.ImpactPoint.Z - startHit.ImpactPoint.Z) > VaultProfileHeightTolerance) {
+				landForwardOffset = sampleForward + VaultLandClearance;
+				bFoundEdge = true;
+				break;
+			}
 		}
 
-		if(i == 4 && hit.bBlockingHit) {
-			outVaultLandPosition = hit.ImpactPoint;
-		}
+		if(!bFoundEdge) { return false; }
 	}
 
-	if(outVaultStartPosition != FVector::ZeroVector &&
-	   outVaultLandPosition != FVector::ZeroVector) {
-		return true;
-	}
+	auto landTraceStart = probeOrigin + componentForward * landForwardOffset;
+	auto landHit = DoLineTraceSingleByObject(landTraceStart, landTraceStart + downVector * VaultLandTraceDepth, EClimbDebugCategory::Vault);
+	if(!landHit.bBlockingHit) { return false; }
 
-	return false;
+	outVaultStartPosition = startHit.ImpactPoint;
+	outVaultLandPosition = landHit.ImpactPoint;
+	return true;
 }
 
 FQuat UCustomMovementComponent::GetClimbRotation(float deltaTime) {
@@ -368,17 +1614,18 @@ FQuat UCustomMovementComponent::GetClimbRotation(float deltaTime) {
 		return currentQuat;
 	}
 
-	auto targetQuat = FRotationMatrix::MakeFromX(-currentClimbableSurfaceNormal).ToQuat();
-	return FMath::QInterpTo(currentQuat, targetQuat, deltaTime, 5.f);
+	return ClimbMath::ComputeClimbRotation(currentQuat, currentClimbableSurfaceNormal, deltaTime);
 }
 
 void UCustomMovementComponent::snapMovementToSurface(float deltaTime) {
-	auto componentForward = UpdatedComponent->GetForwardVector();
-	auto componentLocation = UpdatedComponent->GetComponentLocation();
-	auto projectedCharToSurface = (currentClimbableSurfaceLocation - componentLocation).ProjectOnTo(componentForward);
-
-	auto snapVector = -currentClimbableSurfaceNormal * projectedCharToSurface.Length();
-	UpdatedComponent->MoveComponent(snapVector * deltaTime * MaxClimbSpeed, UpdatedComponent->GetComponentQuat(), true);
+	auto snapDelta = ClimbMath::ComputeSnapDelta(
+		UpdatedComponent->GetComponentLocation(),
+		UpdatedComponent->GetForwardVector(),
+		currentClimbableSurfaceLocation,
+		currentClimbableSurfaceNormal,
+		deltaTime,
+		MaxClimbSpeed);
+	UpdatedComponent->MoveComponent(snapDelta, UpdatedComponent->GetComponentQuat(), true);
 }
 
 bool UCustomMovementComponent::IsClimbing() const {
@@ -386,33 +1633,109 @@ bool UCustomMovementComponent::IsClimbing() const {
 }
 
 bool UCustomMovementComponent::TraceClimbableSurfaces() {
-	auto startOffset = UpdatedComponent->GetForwardVector() * 30.f;
-	auto start = UpdatedComponent->GetComponentLocation() + startOffset;
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_TraceClimbableSurfaces, TraceClimbableSurfaces);
+	if(CanReuseSurfaceCache()) {
+		++surfaceCacheHits;
+		++surfaceCache.TicksSinceRefresh;
+		return !climableSurfacesTracedResults.IsEmpty();
+	}
+
+	FVector start, end;
+	GetClimbableSurfaceTraceSegment(start, end);
+	const bool bHasSurfaces = DoCapsuleTraceMultiByObject(start, end, climableSurfacesTracedResults, EClimbDebugCategory::Surface);
+
+	if(IsClimbing()) {
+		++surfaceCacheMisses;
+		StoreSurfaceCache(UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentQuat());
+	}
+
+	return bHasSurfaces;
+}
+
+FHitResult UCustomMovementComponent::TraceFromEyeHeight(float TraceDistance, float TraceStartOffset, EClimbDebugCategory debugCategory, bool bShowDebugShape, bool bDrawPersistentShapes) {
+	FVector start, end;
+	GetEyeHeightTraceSegment(TraceDistance, TraceStartOffset, start, end);
 
-	auto end = start + UpdatedComponent->GetForwardVector();
-	climableSurfacesTracedResults = DoCapsuleTraceMultiByObject(start, end);
+	return DoLineTraceSingleByObject(start, end, debugCategory, bShowDebugShape, bDrawPersistentShapes);
+}
 
-	return !climableSurfacesTracedResults.IsEmpty();
+void UCustomMovementComponent::GetClimbableSurfaceTraceSegment(FVector& outStart, FVector& outEnd) const {
+	auto startOffset = UpdatedComponent->GetForwardVector() * 30.f;
+	outStart = UpdatedComponent->GetComponentLocation() + startOffset;
+	outEnd = outStart + UpdatedComponent->GetForwardVector();
 }
 
-FHitResult UCustomMovementComponent::TraceFromEyeHeight(float TraceDistance, float TraceStartOffset, bool bShowDebugShape, bool bDrawPersistentShapes) {
+void UCustomMovementComponent::GetEyeHeightTraceSegment(float TraceDistance, float TraceStartOffset, FVector& outStart, FVector& outEnd) const {
 	auto componentLocation = UpdatedComponent->GetComponentLocation();
 	auto eyeHeightOffset = UpdatedComponent->GetUpVector() * (CharacterOwner->BaseEyeHeight + TraceStartOffset);
-	auto start = componentLocation + eyeHeightOffset;
-	auto end = start + UpdatedComponent->GetForwardVector() * TraceDistance;
+	outStart = componentLocation + eyeHeightOffset;
+	outEnd = outStart + UpdatedComponent->GetForwardVector() * TraceDistance;
+}
 
-	return DoLineTraceSingleByObject(start, end, bShowDebugShape, bDrawPersistentShapes);
+void UCustomMovementComponent::GetFloorTraceSegment(FVector& outStart, FVector& outEnd) const {
+	auto downVector = -UpdatedComponent->GetUpVector();
+	auto startOffset = downVector * 50.f;
+	outStart = UpdatedComponent->GetComponentLocation() + startOffset;
+	outEnd = outStart + downVector;
 }
 
-void UCustomMovementComponent::playClimbMontage(UAnimMontage* montageToPlay) {
-	if(!montageToPlay) { return; }
-	if(!owningPlayerAnimInstance) return;
-	if(owningPlayerAnimInstance->IsAnyMontagePlaying()) { return; }
+void UCustomMovementComponent::playClimbMontage(const TSoftObjectPtr<UAnimMontage>& montageToPlay) {
+	if(montageToPlay.IsNull()) { return; }
+	if(IsClimbActionPlaying()) { return; }
+	// a correction replay re-simulates movement only, the montage is already playing from the original move
+	const auto bReplaying = CharacterOwner->bClientUpdating;
+	if(ShouldUseBakedRootMotion() && PlayBakedRootMotion(montageToPlay)) {
+		if(!bReplaying) {
+			PlayCosmeticClimbMontage(montageToPlay);
+		}
+		return;
+	}
+	if(!owningPlayerAnimInstance || bReplaying) return;
+
+	auto* montage = montageToPlay.Get();
+	if(!montage) {
+		// the preload has not caught up, e.g. a teleport next to a wall. Move on the baked curve so the action still
+		// happens, and only hitch on a blocking load when there is no curve either
+		INC_DWORD_STAT(STAT_Climb_MontageFallbacks);
+		RequestClimbMontages();
+		if(RootMotionCache && PlayBakedRootMotion(montageToPlay)) { return; }
+
+		CLIMB_LOG_RATE_LIMITED(Warning, CharacterOwner, 5.f, TEXT("%s: %s was not preloaded, loading it synchronously"), *GetNameSafe(CharacterOwner), *montageToPlay.GetAssetName());
+		montage = montageToPlay.LoadSynchronous();
+		if(!montage) { return; }
+	}
 
-	owningPlayerAnimInstance->Montage_Play(montageToPlay);
+	bClimbMontagesCosmetic = false;
+	owningPlayerAnimInstance->SetRootMotionMode(defaultRootMotionMode);
+	owningPlayerAnimInstance->Montage_Play(montage);
+	UpdateClimbAnimationBudget(true);
+}
+
+bool UCustomMovementComponent::IsClimbActionPlaying() const {
+	return bakedRootMotionSourceID != 0 || (!bClimbMontagesCosmetic && owningPlayerAnimInstance && owningPlayerAnimInstance->IsAnyMontagePlaying());
+}
+
+void UCustomMovementComponent::PublishAnimSnapshot() {
+	// the mesh ticks after its movement component, so worker-thread anim updates never see this mid-write
+	animSnapshot.Velocity = Velocity;
+	animSnapshot.UnrotatedClimbVelocity = getUnrotatedClimbVelocity();
+	animSnapshot.bHasAcceleration = GetCurrentAcceleration().SizeSquared() > 0.f;
+	animSnapshot.bIsFalling = IsFalling();
+	animSnapshot.bIsClimbing = IsClimbing();
 }
 
 void UCustomMovementComponent::onClimbMontageEnded(UAnimMontage* montage, bool interrupted) {
+	// CheckBakedRootMotionFinished ends actions whose montage only played for looks
+	if(bClimbMontagesCosmetic) { return; }
+
+	onClimbActionFinished(TSoftObjectPtr<UAnimMontage>(montage));
+}
+
+void UCustomMovementComponent::onClimbActionFinished(const TSoftObjectPtr<UAnimMontage>& montage) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_OnClimbMontageEnded, onClimbMontageEnded);
+	// soft pointers compare by path, so an unset montage property would match a null montage
+	if(montage.IsNull()) { return; }
+
 	if(montage == IdleToClimbMontage || montage == ClimbDownLedgeMontage) {
 		startClimbing();
 		StopMovementImmediately();
@@ -424,6 +1747,7 @@ void UCustomMovementComponent::onClimbMontageEnded(UAnimMontage* montage, bool i
 }
 
 void UCustomMovementComponent::SetMotionWarpTarget(const FName& inWarpTargetName, const FVector& inTargetPos) {
+	motionWarpTargets.Add(inWarpTargetName, inTargetPos);
 
 	if(!playerChar) { return; }
 	playerChar->GetMotionWarpingComponent()->AddOrUpdateWarpTargetFromLocation(inWarpTargetName, inTargetPos);
@@ -434,10 +1758,19 @@ FVector UCustomMovementComponent::getUnrotatedClimbVelocity() const {
 }
 
 void UCustomMovementComponent::RequestHopping() {
-	auto unrotatedLastInputVector = 
-	UKismetMathLibrary::Quat_UnrotateVector(UpdatedComponent->GetComponentQuat(), GetLastInputVector());
+	bWantsToHop = true;
+}
 
-	auto result = FVector::DotProduct(unrotatedLastInputVector.GetSafeNormal(), FVector::UpVector);
+void UCustomMovementComponent::RequestVaulting() {
+	bWantsToVault = true;
+}
+
+void UCustomMovementComponent::HandleHopping() {
+	// acceleration rather than the last input vector, the server only knows the input through the move's acceleration
+	auto unrotatedAcceleration = 
+	UKismetMathLibrary::Quat_UnrotateVector(UpdatedComponent->GetComponentQuat(), Acceleration);
+
+	auto result = FVector::DotProduct(unrotatedAcceleration.GetSafeNormal(), FVector::UpVector);
 
 	if(result >= 0.9f) {
 		HandleHopUp();
@@ -452,7 +1785,11 @@ void UCustomMovementComponent::RequestHopping() {
 
 void UCustomMovementComponent::HandleHopUp() {
 	FVector hopUpTargetPoint;
-	if(CheckCanHopUp(hopUpTargetPoint)) {
+	const auto* candidates = GetFreshClimbCandidates();
+	if(candidates ? candidates->bCanHopUp : CheckCanHopUp(hopUpTargetPoint)) {
+		if(candidates) {
+			hopUpTargetPoint = candidates->HopUpTarget;
+		}
 		SetMotionWarpTarget(FName("HopUp"), hopUpTargetPoint);
 		playClimbMontage(HopUpMontage);
 	}
@@ -460,15 +1797,20 @@ void UCustomMovementComponent::HandleHopUp() {
 
 void UCustomMovementComponent::HandleHopDown() {
 	FVector hopDownTargetPoint;
-	if(CheckCanHopDown(hopDownTargetPoint)) {
+	const auto* candidates = GetFreshClimbCandidates();
+	if(candidates ? candidates->bCanHopDown : CheckCanHopDown(hopDownTargetPoint)) {
+		if(candidates) {
+			hopDownTargetPoint = candidates->HopDownTarget;
+		}
 		SetMotionWarpTarget(FName("HopDown"), hopDownTargetPoint);
 		playClimbMontage(HopDownMontage);
 	}
 }
 
 bool UCustomMovementComponent::CheckCanHopUp(FVector& inTargetPos) {
-	auto hit = TraceFromEyeHeight(100.f, -10.f);
-	auto ledgeHit = TraceFromEyeHeight(100.f, 150.f);
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_CheckCanHopUp, CheckCanHopUp);
+	auto hit = TraceFromEyeHeight(100.f, -10.f, EClimbDebugCategory::Hop);
+	auto ledgeHit = TraceFromEyeHeight(100.f, ClimbHopUpReach, EClimbDebugCategory::Hop);
 	
 	if(hit.bBlockingHit && ledgeHit.bBlockingHit) {
 		inTargetPos = hit.ImpactPoint;
@@ -479,7 +1821,8 @@ bool UCustomMovementComponent::CheckCanHopUp(FVector& inTargetPos) {
 }
 
 bool UCustomMovementComponent::CheckCanHopDown(FVector& inTargetPos) {
-	auto hit = TraceFromEyeHeight(100.f, -300.f, true, true);
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_CheckCanHopDown, CheckCanHopDown);
+	auto hit = TraceFromEyeHeight(100.f, -ClimbHopDownReach, EClimbDebugCategory::Hop);
 
 	if(hit.bBlockingHit) {
 		inTargetPos = hit.ImpactPoint;
@@ -490,3 +1833,64 @@ bool UCustomMovementComponent::CheckCanHopDown(FVector& inTargetPos) {
 }
 
 #pragma endregion
+
+#pragma region SavedMove
+void FSavedMove_Climb::Clear() {
+	Super::Clear();
+
+	savedClimbSurfaceNormal = FVector::ZeroVector;
+	savedCombineMinNormalDot = 1.f;
+	bSavedWantsToClimb = false;
+	bSavedWantsToStopClimbing = false;
+	bSavedWantsToHop = false;
+	bSavedWantsToVault = false;
+}
+
+uint8 FSavedMove_Climb::GetCompressedFlags() const {
+	auto flags = Super::GetCompressedFlags();
+
+	if(bSavedWantsToClimb) { flags |= FLAG_Climb; }
+	if(bSavedWantsToStopClimbing) { flags |= FLAG_StopClimb; }
+	if(bSavedWantsToHop) { flags |= FLAG_Hop; }
+	if(bSavedWantsToVault) { flags |= FLAG_Vault; }
+
+	return flags;
+}
+
+bool FSavedMove_Climb::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const {
+	const auto* newClimbMove = static_cast<const FSavedMove_Climb*>(NewMove.Get());
+
+	// a request has to reach the server on the move it was made in
+	if((GetCompressedFlags() | newClimbMove->GetCompressedFlags()) & FLAG_ClimbRequests) { return false; }
+
+	// steady climbing on one face combines, rounding a corner does not
+	if(!savedClimbSurfaceNormal.IsZero() && !newClimbMove->savedClimbSurfaceNormal.IsZero() &&
+	   FVector::DotProduct(savedClimbSurfaceNormal, newClimbMove->savedClimbSurfaceNormal) < savedCombineMinNormalDot) {
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Climb::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) {
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	const auto* movement = Cast<UCustomMovementComponent>(C->GetCharacterMovement());
+	if(!movement) { return; }
+
+	bSavedWantsToClimb = movement->bWantsToClimb;
+	bSavedWantsToStopClimbing = movement->bWantsToStopClimbing;
+	bSavedWantsToHop = movement->bWantsToHop;
+	bSavedWantsToVault = movement->bWantsToVault;
+	savedClimbSurfaceNormal = movement->IsClimbing() ? movement->GetClimbableSurfaceNormal() : FVector::ZeroVector;
+	savedCombineMinNormalDot = FMath::Cos(FMath::DegreesToRadians(movement->ClimbMoveCombineMaxNormalAngle));
+}
+
+FNetworkPredictionData_Client_Climb::FNetworkPredictionData_Client_Climb(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement) {
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Climb::AllocateNewMove() {
+	return FSavedMovePtr(new FSavedMove_Climb());
+}
+#pragma endregion
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Debug/ClimbDebugDrawSubsystem.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+
+#if CLIMB_DEBUG_DRAW
+namespace {
+	TAutoConsoleVariable<bool> CVarClimbDebugSurface(TEXT("climb.Debug.Surface"), false, TEXT("Draw climbable surface capsule traces."));
+	TAutoConsoleVariable<bool> CVarClimbDebugFloor(TEXT("climb.Debug.Floor"), false, TEXT("Draw the floor check while climbing."));
+	TAutoConsoleVariable<bool> CVarClimbDebugEyeHeight(TEXT("climb.Debug.EyeHeight"), false, TEXT("Draw eye height traces used to start climbing."));
+	TAutoConsoleVariable<bool> CVarClimbDebugLedge(TEXT("climb.Debug.Ledge"), false, TEXT("Draw ledge and climb down traces."));
+	TAutoConsoleVariable<bool> CVarClimbDebugHop(TEXT("climb.Debug.Hop"), false, TEXT("Draw hop up and hop down traces."));
+	TAutoConsoleVariable<bool> CVarClimbDebugVault(TEXT("climb.Debug.Vault"), false, TEXT("Draw vault probe traces."));
+	TAutoConsoleVariable<float> CVarClimbDebugDuration(TEXT("climb.Debug.Duration"), 0.f, TEXT("Seconds a climb debug shape stays on screen, 0 draws it for a single frame."));
+	TAutoConsoleVariable<float> CVarClimbDebugTimedDuration(TEXT("climb.Debug.TimedDuration"), 5.f, TEXT("Seconds shapes requested as persistent stay on screen."));
+
+	FAutoConsoleCommandWithWorld CmdClimbDebugClear(
+		TEXT("climb.Debug.Clear"),
+		TEXT("Drop every buffered climb debug shape."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* world) {
+			if(auto* subsystem = UClimbDebugDrawSubsystem::Get(world)) {
+				subsystem->Clear();
+			}
+		}));
+
+	const TAutoConsoleVariable<bool>* const CategoryCVars[] = {
+		&CVarClimbDebugSurface,
+		&CVarClimbDebugFloor,
+		&CVarClimbDebugEyeHeight,
+		&CVarClimbDebugLedge,
+		&CVarClimbDebugHop,
+		&CVarClimbDebugVault,
+	};
+	static_assert(UE_ARRAY_COUNT(CategoryCVars) == static_cast<int32>(EClimbDebugCategory::Count), "every climb debug category needs a cvar");
+}
+#endif
+
+bool UClimbDebugDrawSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+#if CLIMB_DEBUG_DRAW
+	return Super::ShouldCreateSubsystem(Outer);
+#else
+	return false;
+#endif
+}
+
+TStatId UClimbDebugDrawSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbDebugDrawSubsystem, STATGROUP_Tickables);
+}
+
+void UClimbDebugDrawSubsystem::Tick(float DeltaTime) {
+#if CLIMB_DEBUG_DRAW
+	Super::Tick(DeltaTime);
+	if(numShapes == 0) { return; }
+
+	const auto* world = GetWorld();
+	const auto now = world->GetTimeSeconds();
+
+	// walk oldest to newest so the expired prefix can be dropped, expired shapes further in are overwritten as the ring wraps
+	const auto first = (nextShape - numShapes + MaxShapes) % MaxShapes;
+	auto expiredPrefix = 0;
+	for(int32 i = 0; i < numShapes; ++i) {
+		const auto& shape = shapes[(first + i) % MaxShapes];
+		if(shape.ExpireTime < now) {
+			if(expiredPrefix == i) {
+				++expiredPrefix;
+			}
+			continue;
+		}
+
+		switch(shape.Type) {
+			case EShapeType::Line:
+				DrawDebugLine(world, shape.A, shape.B, shape.Color);
+				break;
+			case EShapeType::Point:
+				DrawDebugPoint(world, shape.A, shape.Size, shape.Color);
+				break;
+			case EShapeType::Capsule:
+				DrawDebugCapsule(world, shape.A, shape.B.X, shape.Size, FQuat::Identity, shape.Color);
+				break;
+		}
+	}
+	numShapes -= expiredPrefix;
+#endif
+}
+
+#if CLIMB_DEBUG_DRAW
+UClimbDebugDrawSubsystem* UClimbDebugDrawSubsystem::Get(const UWorld* world) {
+	return world ? world->GetSubsystem<UClimbDebugDrawSubsystem>() : nullptr;
+}
+
+bool UClimbDebugDrawSubsystem::IsCategoryEnabled(EClimbDebugCategory category) {
+	if(category >= EClimbDebugCategory::Count) { return false; }
+	return CategoryCVars[static_cast<int32>(category)]->GetValueOnGameThread();
+}
+
+void UClimbDebugDrawSubsystem::AddLine(const FVector& start, const FVector& end, const FColor& color, bool bTimed) {
+	auto& shape = AllocateShape(EShapeType::Line, color, bTimed);
+	shape.A = start;
+	shape.B = end;
+}
+
+void UClimbDebugDrawSubsystem::AddPoint(const FVector& location, float size, const FColor& color, bool bTimed) {
+	auto& shape = AllocateShape(EShapeType::Point, color, bTimed);
+	shape.A = location;
+	shape.Size = size;
+}
+
+void UClimbDebugDrawSubsystem::AddCapsule(const FVector& center, float halfHeight, float radius, const FColor& color, bool bTimed) {
+	auto& shape = AllocateShape(EShapeType::Capsule, color, bTimed);
+	shape.A = center;
+	shape.B = FVector(halfHeight, 0.f, 0.f);
+	shape.Size = radius;
+}
+
+void UClimbDebugDrawSubsystem::Clear() {
+	nextShape = 0;
+	numShapes = 0;
+}
+
+UClimbDebugDrawSubsystem::FShape& UClimbDebugDrawSubsystem::AllocateShape(EShapeType type, const FColor& color, bool bTimed) {
+	// a full buffer overwrites its oldest shape instead of growing
+	auto& shape = shapes[nextShape];
+	nextShape = (nextShape + 1) % MaxShapes;
+	numShapes = FMath::Min(numShapes + 1, MaxShapes);
+
+	const auto duration = bTimed ? CVarClimbDebugTimedDuration.GetValueOnGameThread() : CVarClimbDebugDuration.GetValueOnGameThread();
+	shape.Type = type;
+	shape.Color = color;
+	shape.Size = 0.f;
+	shape.ExpireTime = GetWorld()->GetTimeSeconds() + FMath::Max(duration, 0.f);
+	return shape;
+}
+#endif
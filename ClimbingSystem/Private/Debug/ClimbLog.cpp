@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Debug/ClimbLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/OutputDeviceFile.h"
+#include "Misc/Paths.h"
+
+namespace ClimbLog {
+	namespace {
+		std::atomic<uint64> rateLimitCycles[RateLimitSlots];
+		FDelegateHandle crashDumpHandle;
+
+		// the heap may be what crashed, so the crash dump resolves its path at startup and only formats into these
+		constexpr int32 CrashLineLength = MaxMessageLength + 64;
+		TCHAR crashDumpPath[1024];
+		TCHAR crashLine[CrashLineLength];
+		UTF8CHAR crashLineUtf8[CrashLineLength * 4];
+
+		FAutoConsoleCommand CmdClimbLogDump(
+			TEXT("climb.Log.Dump"),
+			TEXT("Print the climb log ring buffer, pass 'file' to write it to Saved/Logs instead."),
+			FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& args) {
+				if(args.Num() > 0 && args[0] == TEXT("file")) {
+					UE_LOG(LogClimbing, Display, TEXT("climb log written to %s"), *DumpToFile());
+				} else if(GLog) {
+					Dump(*GLog);
+				}
+			}));
+
+		/** Writes the ring straight through the physical platform file, the handle it opens is the only allocation left */
+		void DumpOnCrash() {
+			if(!crashDumpPath[0]) { return; }
+
+			auto* file = IPlatformFile::GetPlatformPhysical().OpenWrite(crashDumpPath);
+			if(!file) { return; }
+
+			const auto writeLine = [file](const TCHAR* line) {
+				const auto* end = FPlatformString::Convert(crashLineUtf8, UE_ARRAY_COUNT(crashLineUtf8), line, FCString::Strlen(line));
+				if(end) {
+					file->Write(reinterpret_cast<const uint8*>(crashLineUtf8), end - crashLineUtf8);
+				}
+			};
+			writeLine(TEXT("---- climb log ring (newest last) ----") LINE_TERMINATOR);
+			GetRing().ForEachEntry([&writeLine](double time, uint64 frame, ELogVerbosity::Type verbosity, const TCHAR* message) {
+				FCString::Snprintf(crashLine, CrashLineLength, TEXT("[%.3f][%llu] %s: %s") LINE_TERMINATOR, time, frame, ToString(verbosity), message);
+				writeLine(crashLine);
+			});
+
+			file->Flush();
+			delete file;
+		}
+	}
+
+	void FRing::Write(ELogVerbosity::Type verbosity, const TCHAR* message) {
+		const auto index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+		auto& entry = entries[index % RingCapacity];
+
+		// seqlock style, readers drop the entry if the sequence moved while they copied it
+		entry.Sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		entry.Time = FPlatformTime::Seconds();
+		entry.Frame = GFrameCounter;
+		entry.Verbosity = verbosity;
+		FCString::Strncpy(entry.Message, message, MaxMessageLength);
+		entry.Sequence.store(index + 1, std::memory_order_release);
+	}
+
+	void FRing::ForEachEntry(TFunctionRef<void(double, uint64, ELogVerbosity::Type, const TCHAR*)> visitor) const {
+		const auto end = writeIndex.load(std::memory_order_acquire);
+		const auto begin = end > RingCapacity ? end - RingCapacity : 0;
+
+		TCHAR message[MaxMessageLength];
+		for(auto index = begin; index < end; ++index) {
+			const auto& entry = entries[index % RingCapacity];
+			if(entry.Sequence.load(std::memory_order_acquire) != index + 1) { continue; }
+
+			const auto time = entry.Time;
+			const auto frame = entry.Frame;
+			const auto verbosity = entry.Verbosity;
+			FMemory::Memcpy(message, entry.Message, sizeof(message));
+			message[MaxMessageLength - 1] = TEXT('\0');
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(entry.Sequence.load(std::memory_order_relaxed) != index + 1) { continue; }
+
+			visitor(time, frame, verbosity, message);
+		}
+	}
+
+	FRing& GetRing() {
+		static FRing ring;
+		return ring;
+	}
+
+	void Write(ELogVerbosity::Type verbosity, const TCHAR* message) {
+		GetRing().Write(verbosity, message);
+
+#if !NO_LOGGING
+		if(!LogClimbing.IsSuppressed(verbosity)) {
+			FMsg::Logf(__FILE__, __LINE__, LogClimbing.GetCategoryName(), verbosity, TEXT("%s"), message);
+		}
+#endif
+	}
+
+	bool ConsumeRateLimit(uint32 keyHash, float interval) {
+		auto& slot = rateLimitCycles[keyHash % RateLimitSlots];
+		const auto now = FPlatformTime::Cycles64();
+		const auto intervalCycles = static_cast<uint64>(interval / FPlatformTime::GetSecondsPerCycle64());
+
+		auto last = slot.load(std::memory_order_relaxed);
+		do {
+			if(last != 0 && now - last < intervalCycles) { return false; }
+		} while(!slot.compare_exchange_weak(last, now, std::memory_order_relaxed));
+		return true;
+	}
+
+	void Dump(FOutputDevice& output) {
+		output.Logf(TEXT("---- climb log ring (newest last) ----"));
+		GetRing().ForEachEntry([&output](double time, uint64 frame, ELogVerbosity::Type verbosity, const TCHAR* message) {
+			output.Logf(TEXT("[%.3f][%llu] %s: %s"), time, frame, ToString(verbosity), message);
+		});
+	}
+
+	FString DumpToFile() {
+		const auto fileName = FPaths::ProjectLogDir() / FString::Printf(TEXT("ClimbLog-%s.log"), *FDateTime::Now().ToString());
+		FOutputDeviceFile file(*fileName, true);
+		file.SetSuppressEventTag(true);
+		Dump(file);
+		file.TearDown();
+		return fileName;
+	}
+
+	void RegisterCrashDump() {
+		const auto logDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectLogDir());
+		IPlatformFile::GetPlatformPhysical().CreateDirectoryTree(*logDir);
+		FCString::Strncpy(crashDumpPath, *(logDir / FString::Printf(TEXT("ClimbLog-Crash-%s.log"), *FDateTime::Now().ToString())), UE_ARRAY_COUNT(crashDumpPath));
+		crashDumpHandle = FCoreDelegates::OnHandleSystemError.AddStatic(&DumpOnCrash);
+	}
+
+	void UnregisterCrashDump() {
+		FCoreDelegates::OnHandleSystemError.Remove(crashDumpHandle);
+	}
+}
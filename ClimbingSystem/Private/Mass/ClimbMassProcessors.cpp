@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Mass/ClimbMassProcessors.h"
+#include "Mass/ClimbMassFragments.h"
+#include "Climbing/ClimbMath.h"
+#include "Climbing/ClimbMathBatch.h"
+#include "Climbing/ClimbingStats.h"
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "Components/CustomMovementComponent.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Algo/Sort.h"
+
+#pragma region SurfaceQuery
+UClimbSurfaceQueryProcessor::UClimbSurfaceQueryProcessor() {
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::Movement;
+	// async trace requests have to be made from the game thread
+	bRequiresGameThreadExecution = true;
+}
+
+void UClimbSurfaceQueryProcessor::ConfigureQueries() {
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FClimbSurfaceFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FClimbStateFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddConstSharedRequirement<FClimbMassParams>(EMassFragmentPresence::All);
+	EntityQuery.AddTagRequirement<FClimbMassAgentTag>(EMassFragmentPresence::All);
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void UClimbSurfaceQueryProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_MassSurfaceQuery, MassSurfaceQuery);
+	auto* world = EntityManager.GetWorld();
+	if(!world) { return; }
+
+	const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(ClimbMassSurfaceTrace), false);
+	FTraceDatum traceData;
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context) {
+		const auto& params = Context.GetConstSharedFragment<FClimbMassParams>();
+		const auto transforms = Context.GetFragmentView<FTransformFragment>();
+		const auto states = Context.GetFragmentView<FClimbStateFragment>();
+		const auto surfaces = Context.GetMutableFragmentView<FClimbSurfaceFragment>();
+
+		const FCollisionObjectQueryParams objectQueryParams(params.ClimableSurfaceTraceTypes);
+		const auto capsuleShape = FCollisionShape::MakeCapsule(params.ClimbCapsuleTraceRadius, params.ClimbCapsuleTraceHalfHeight);
+
+		for(auto i = 0; i < Context.GetNumEntities(); ++i) {
+			auto& surface = surfaces[i];
+
+			if(surface.PendingTrace.IsValid()) {
+				if(world->QueryTraceData(surface.PendingTrace, traceData)) {
+					surface.NumHits = ClimbMath::AverageSurfaceHits(traceData.OutHits, surface.Location, surface.Normal);
+					surface.bHasResult = true;
+					surface.PendingTrace = FTraceHandle();
+				} else if(!world->IsTraceHandleValid(surface.PendingTrace, false)) {
+					// the frame it was issued in has been recycled, it will never come back
+					surface.PendingTrace = FTraceHandle();
+				}
+			}
+
+			// one sweep in flight per agent, a pending one is kept until its results are in
+			if(states[i].Mode != EClimbMassMode::Climbing || surface.PendingTrace.IsValid()) { continue; }
+
+			const auto& transform = transforms[i].GetTransform();
+			const auto forward = transform.GetRotation().GetForwardVector();
+			const auto start = transform.GetLocation() + forward * 30.f;
+			INC_DWORD_STAT(STAT_Climb_SceneQueries);
+			surface.PendingTrace = world->AsyncSweepByObjectType(EAsyncTraceType::Multi, start, start + forward, FQuat::Identity, objectQueryParams, capsuleShape, queryParams);
+		}
+	});
+}
+#pragma endregion
+
+#pragma region Movement
+UClimbMovementProcessor::UClimbMovementProcessor() {
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteInGroup = UE::Mass::ProcessorGroupNames::Movement;
+	ExecutionOrder.ExecuteAfter.Add(UClimbSurfaceQueryProcessor::StaticClass()->GetFName());
+}
+
+void UClimbMovementProcessor::ConfigureQueries() {
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FClimbSurfaceFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FClimbStateFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FClimbMassParams>(EMassFragmentPresence::All);
+	EntityQuery.AddTagRequirement<FClimbMassAgentTag>(EMassFragmentPresence::All);
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void UClimbMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) {
+	CLIMB_SCOPE_CYCLE_COUNTER(STAT_Climb_MassMovement, MassMovement);
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context) {
+		const auto deltaTime = Context.GetDeltaTimeSeconds();
+		if(deltaTime < MIN_TICK_TIME) { return; }
+
+		const auto& params = Context.GetConstSharedFragment<FClimbMassParams>();
+		const auto surfaces = Context.GetFragmentView<FClimbSurfaceFragment>();
+		const auto transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const auto states = Context.GetMutableFragmentView<FClimbStateFragment>();
+		const auto numEntities = Context.GetNumEntities();
+
+		// one batch per worker, reused across chunks so the lanes only allocate while the largest chunk grows
+		static thread_local ClimbMath::FClimbSurfaceBatch batch;
+		batch.Reset(numEntities);
+
+		for(auto i = 0; i < numEntities; ++i) {
+			batch.SetNormal(i, surfaces[i].Normal);
+		}
+		batch.ComputeShouldStop();
+
+		for(auto i = 0; i < numEntities; ++i) {
+			auto& state = states[i];
+			if(state.Mode != EClimbMassMode::Climbing) { continue; }
+
+			const auto& surface = surfaces[i];
+			// hold still until the first sweep lands, only a sweep that came back empty detaches
+			if(!surface.bHasResult) { continue; }
+			if(surface.NumHits == 0 || batch.ShouldStop(i)) {
+				state.Mode = EClimbMassMode::Detached;
+				state.Velocity = FVector::ZeroVector;
+				continue;
+			}
+
+			auto& transform = transforms[i].GetMutableTransform();
+			const auto rotation = transform.GetRotation();
+
+			const auto inputDirection = ClimbMath::ComputeClimbInputDirection(state.MoveInput, surface.Normal, rotation.GetRightVector(), rotation.GetUpVector());
+			const auto targetVelocity = inputDirection.GetClampedToMaxSize(1.f) * params.MaxClimbSpeed;
+			state.Velocity = FMath::VInterpConstantTo(state.Velocity, targetVelocity, deltaTime, params.MaxClimbAcceleration);
+
+			// the slerp stays per agent, only the snap projection is wide enough to be worth batching
+			const auto newRotation = ClimbMath::ComputeClimbRotation(rotation, surface.Normal, deltaTime);
+			const auto newLocation = transform.GetLocation() + state.Velocity * deltaTime;
+			batch.SetClimber(i, newLocation, newRotation.GetForwardVector(), surface.Location, surface.Normal);
+
+			transform.SetLocation(newLocation);
+			transform.SetRotation(newRotation);
+		}
+
+		// detached, stopped and waiting lanes were never filled, they come back as a zero snap
+		batch.ComputeSnapDeltas(deltaTime, params.MaxClimbSpeed);
+		for(auto i = 0; i < numEntities; ++i) {
+			if(states[i].Mode != EClimbMassMode::Climbing || !surfaces[i].bHasResult) { continue; }
+
+			auto& transform = transforms[i].GetMutableTransform();
+			transform.AddToTranslation(batch.GetSnapDelta(i));
+		}
+	});
+}
+#pragma endregion
+
+#pragma region Promotion
+UClimbPromotionProcessor::UClimbPromotionProcessor() {
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Standalone | EProcessorExecutionFlags::Server);
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+	// spawns actors
+	bRequiresGameThreadExecution = true;
+}
+
+void UClimbPromotionProcessor::ConfigureQueries() {
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FClimbStateFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FClimbPromotedCharacterFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FClimbMassParams>(EMassFragmentPresence::All);
+	EntityQuery.AddTagRequirement<FClimbMassAgentTag>(EMassFragmentPresence::All);
+	EntityQuery.RegisterWithProcessor(*this);
+
+	PromotedQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	PromotedQuery.AddRequirement<FClimbStateFragment>(EMassFragmentAccess::ReadWrite);
+	PromotedQuery.AddRequirement<FClimbSurfaceFragment>(EMassFragmentAccess::ReadWrite);
+	PromotedQuery.AddRequirement<FClimbPromotedCharacterFragment>(EMassFragmentAccess::ReadWrite);
+	PromotedQuery.AddConstSharedRequirement<FClimbMassParams>(EMassFragmentPresence::All);
+	PromotedQuery.AddTagRequirement<FClimbMassPromotedTag>(EMassFragmentPresence::All);
+	PromotedQuery.RegisterWithProcessor(*this);
+}
+
+void UClimbPromotionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) {
+	auto* world = EntityManager.GetWorld();
+	if(!world) { return; }
+
+	TArray<FVector, TInlineAllocator<8>> playerLocations;
+	for(auto it = world->GetPlayerControllerIterator(); it; ++it) {
+		if(const auto* pawn = it->Get() ? it->Get()->GetPawn() : nullptr) {
+			playerLocations.Add(pawn->GetActorLocation());
+		}
+	}
+
+	// demote first, with no players left every promoted character goes back to being an agent
+	DemoteCharacters(EntityManager, Context, playerLocations);
+	if(playerLocations.IsEmpty()) { return; }
+
+	PromoteAgents(EntityManager, Context, playerLocations);
+}
+
+void UClimbPromotionProcessor::DemoteCharacters(FMassEntityManager& EntityManager, FMassExecutionContext& Context, TConstArrayView<FVector> playerLocations) {
+	PromotedQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context) {
+		const auto& params = Context.GetConstSharedFragment<FClimbMassParams>();
+		const auto transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const auto states = Context.GetMutableFragmentView<FClimbStateFragment>();
+		const auto surfaces = Context.GetMutableFragmentView<FClimbSurfaceFragment>();
+		const auto promoted = Context.GetMutableFragmentView<FClimbPromotedCharacterFragment>();
+		const auto demotionDistanceSquared = FMath::Square(FMath::Max(params.DemotionDistance, params.PromotionDistance));
+
+		for(auto i = 0; i < Context.GetNumEntities(); ++i) {
+			auto* character = promoted[i].Character.Get();
+			if(!character) {
+				// gameplay destroyed the stand-in, the agent goes with it
+				Context.Defer().DestroyEntity(Context.GetEntity(i));
+				continue;
+			}
+
+			const auto location = character->GetActorLocation();
+			const bool bNearPlayer = playerLocations.ContainsByPredicate([&](const FVector& playerLocation) {
+				return FVector::DistSquared(playerLocation, location) <= demotionDistanceSquared;
+			});
+			if(bNearPlayer) { continue; }
+
+			transforms[i].GetMutableTransform() = character->GetActorTransform();
+			if(const auto* movementComponent = character->GetCustomMovementComponent()) {
+				states[i].Velocity = movementComponent->Velocity;
+				states[i].Mode = movementComponent->IsClimbing() ? EClimbMassMode::Climbing : EClimbMassMode::Detached;
+			}
+			// the last sweep was made where the agent stood before it was promoted
+			surfaces[i] = FClimbSurfaceFragment();
+
+			character->Destroy();
+			promoted[i].Character = nullptr;
+			Context.Defer().SwapTags<FClimbMassPromotedTag, FClimbMassAgentTag>(Context.GetEntity(i));
+		}
+	});
+}
+
+void UClimbPromotionProcessor::PromoteAgents(FMassEntityManager& EntityManager, FMassExecutionContext& Context, TConstArrayView<FVector> playerLocations) {
+	struct FPromotionCandidate {
+		FMassEntityHandle Entity;
+		FTransform Transform;
+		FClimbStateFragment State;
+		UClass* CharacterClass = nullptr;
+		double DistSquared = 0.0;
+	};
+	TArray<FPromotionCandidate> candidates;
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context) {
+		const auto& params = Context.GetConstSharedFragment<FClimbMassParams>();
+		const auto transforms = Context.GetFragmentView<FTransformFragment>();
+		const auto states = Context.GetFragmentView<FClimbStateFragment>();
+		const auto promotionDistanceSquared = FMath::Square(params.PromotionDistance);
+
+		UClass* characterClass = params.PromotedCharacterClass ? params.PromotedCharacterClass.Get() : AClimbingSystemCharacter::StaticClass();
+
+		for(auto i = 0; i < Context.GetNumEntities(); ++i) {
+			const auto& transform = transforms[i].GetTransform();
+			auto nearestSquared = MAX_dbl;
+			for(const auto& playerLocation : playerLocations) {
+				nearestSquared = FMath::Min(nearestSquared, FVector::DistSquared(playerLocation, transform.GetLocation()));
+			}
+			if(nearestSquared > promotionDistanceSquared) { continue; }
+
+			candidates.Add({ Context.GetEntity(i), transform, states[i], characterClass, nearestSquared });
+		}
+	});
+
+	// the agents a player is about to reach get their characters first, the rest follow on later frames
+	if(candidates.Num() > MaxPromotionsPerFrame) {
+		Algo::Sort(candidates, [](const FPromotionCandidate& a, const FPromotionCandidate& b) { return a.DistSquared < b.DistSquared; });
+		candidates.SetNum(MaxPromotionsPerFrame, false);
+	}
+
+	auto* world = EntityManager.GetWorld();
+	for(const auto& candidate : candidates) {
+		FActorSpawnParameters spawnParams;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		auto* character = world->SpawnActor<AClimbingSystemCharacter>(candidate.CharacterClass, candidate.Transform, spawnParams);
+		if(!character) { continue; }
+
+		if(auto* movementComponent = character->GetCustomMovementComponent()) {
+			if(candidate.State.Mode == EClimbMassMode::Climbing) {
+				movementComponent->EnterClimbImmediately(candidate.State.Velocity);
+			}
+		}
+
+		EntityManager.GetFragmentDataChecked<FClimbPromotedCharacterFragment>(candidate.Entity).Character = character;
+		Context.Defer().SwapTags<FClimbMassAgentTag, FClimbMassPromotedTag>(candidate.Entity);
+	}
+}
+#pragma endregion
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Mass/ClimbMassTrait.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+#include "MassEntityUtils.h"
+
+void UClimbMassTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const {
+	BuildContext.RequireFragment<FTransformFragment>();
+	BuildContext.AddFragment<FClimbSurfaceFragment>();
+	BuildContext.AddFragment<FClimbStateFragment>();
+	BuildContext.AddFragment<FClimbPromotedCharacterFragment>();
+	BuildContext.AddTag<FClimbMassAgentTag>();
+
+	auto& entityManager = UE::Mass::Utils::GetEntityManagerChecked(World);
+	const auto paramsHash = UE::StructUtils::GetStructCrc32(FConstStructView::Make(Params));
+	BuildContext.AddConstSharedFragment(entityManager.GetOrCreateConstSharedFragment(paramsHash, Params));
+}
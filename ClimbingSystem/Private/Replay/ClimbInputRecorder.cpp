@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/ClimbInputRecorder.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace {
+	constexpr uint32 ClimbInputLogMagic = 0x434C5243; // 'CLRC'
+	constexpr uint32 ClimbInputLogVersion = 1;
+}
+
+FArchive& operator<<(FArchive& Ar, FClimbInputRecord& record) {
+	Ar << record.Frame;
+	Ar << record.Event;
+	Ar << record.Value;
+	return Ar;
+}
+
+void FClimbInputRecorder::StartRecording(const FString& inLogPath, float inFixedDeltaTime, const FTransform& inStartTransform, const FRotator& inStartControlRotation) {
+	Stop();
+
+	mode = EMode::Recording;
+	logPath = inLogPath;
+	fixedDeltaTime = inFixedDeltaTime;
+	startTransform = inStartTransform;
+	startControlRotation = inStartControlRotation;
+	records.Reset();
+	currentFrame = 0;
+	checksum = 0;
+
+	SetFixedTimeStep(true);
+}
+
+bool FClimbInputRecorder::StartReplay(const FString& inLogPath) {
+	Stop();
+
+	TArray<uint8> bytes;
+	if(!FFileHelper::LoadFileToArray(bytes, *inLogPath)) { return false; }
+
+	FMemoryReader reader(bytes);
+	uint32 magic = 0, version = 0;
+	reader << magic << version;
+	if(magic != ClimbInputLogMagic || version != ClimbInputLogVersion) { return false; }
+
+	reader << fixedDeltaTime << startTransform << startControlRotation << recordedFrameCount << recordedChecksum << records;
+	if(reader.IsError()) { return false; }
+
+	mode = EMode::Replaying;
+	logPath = inLogPath;
+	replayCursor = 0;
+	currentFrame = 0;
+	checksum = 0;
+	frameTimesMs.Reset(recordedFrameCount);
+	lastFrameSeconds = FPlatformTime::Seconds();
+
+	SetFixedTimeStep(true);
+	return true;
+}
+
+void FClimbInputRecorder::Stop() {
+	if(mode == EMode::Recording) {
+		recordedFrameCount = currentFrame;
+		recordedChecksum = checksum;
+		SaveLog();
+	} else if(mode == EMode::Replaying) {
+		SaveReplayReport();
+	}
+
+	if(mode != EMode::Idle) {
+		SetFixedTimeStep(false);
+	}
+	mode = EMode::Idle;
+}
+
+void FClimbInputRecorder::Record(EClimbInputEvent event, const FVector2D& value) {
+	if(!IsRecording()) { return; }
+
+	records.Add({ currentFrame, event, FVector2f(value) });
+}
+
+void FClimbInputRecorder::AdvanceFrame(const FVector& location, const FRotator& rotation, bool bIsClimbing) {
+	if(mode == EMode::Idle) { return; }
+
+	// quantize so float noise below the millimetre or centidegree does not count as a behaviour change
+	const int32 quantizedPose[] = {
+		FMath::RoundToInt(location.X * 10.f),
+		FMath::RoundToInt(location.Y * 10.f),
+		FMath::RoundToInt(location.Z * 10.f),
+		FMath::RoundToInt(rotation.Pitch * 100.f),
+		FMath::RoundToInt(rotation.Yaw * 100.f),
+		FMath::RoundToInt(rotation.Roll * 100.f),
+		bIsClimbing ? 1 : 0
+	};
+	checksum = FCrc::MemCrc32(quantizedPose, sizeof(quantizedPose), checksum);
+
+	if(IsReplaying()) {
+		const auto now = FPlatformTime::Seconds();
+		frameTimesMs.Add(static_cast<float>((now - lastFrameSeconds) * 1000.0));
+		lastFrameSeconds = now;
+	}
+
+	++currentFrame;
+}
+
+void FClimbInputRecorder::SaveLog() {
+	TArray<uint8> bytes;
+	FMemoryWriter writer(bytes);
+
+	auto magic = ClimbInputLogMagic;
+	auto version = ClimbInputLogVersion;
+	writer << magic << version << fixedDeltaTime << startTransform << startControlRotation << recordedFrameCount << recordedChecksum << records;
+
+	FFileHelper::SaveArrayToFile(bytes, *logPath);
+	UE_LOG(LogClimbing, Display, TEXT("ClimbInputRecorder: wrote %d events over %u frames to %s (checksum %08x)"), records.Num(), recordedFrameCount, *logPath, recordedChecksum);
+}
+
+void FClimbInputRecorder::SaveReplayReport() const {
+	FString report = FString::Printf(TEXT("# recorded_checksum=%08x replay_checksum=%08x frames=%d\nframe,ms\n"), recordedChecksum, checksum, frameTimesMs.Num());
+	for(auto i = 0; i < frameTimesMs.Num(); ++i) {
+		report += FString::Printf(TEXT("%d,%.4f\n"), i, frameTimesMs[i]);
+	}
+
+	const auto reportPath = FPaths::ChangeExtension(logPath, TEXT("replay.csv"));
+	FFileHelper::SaveStringToFile(report, *reportPath);
+
+	if(checksum == recordedChecksum) {
+		UE_LOG(LogClimbing, Display, TEXT("ClimbInputRecorder: replay matched (checksum %08x), timings in %s"), checksum, *reportPath);
+	} else {
+		UE_LOG(LogClimbing, Warning, TEXT("ClimbInputRecorder: replay diverged, recorded %08x replayed %08x, timings in %s"), recordedChecksum, checksum, *reportPath);
+	}
+}
+
+void FClimbInputRecorder::SetFixedTimeStep(bool bEnable) {
+	if(bEnable) {
+		bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+		previousFixedDeltaTime = FApp::GetFixedDeltaTime();
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(fixedDeltaTime);
+	} else {
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(previousFixedDeltaTime);
+	}
+}
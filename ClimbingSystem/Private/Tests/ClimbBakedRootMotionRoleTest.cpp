@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Animation/AnimInstance.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbBakedRootMotionRoleTest, "ClimbingSystem.Networking.BakedRootMotionMatchesServer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbBakedRootMotionRoleTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world"), testWorld.IsValid())) { return false; }
+	testWorld.BeginPlay();
+
+	auto* climber = testWorld.SpawnClimber(FVector(0.f, 0.f, 100.f));
+	if(!TestNotNull(TEXT("climber"), climber)) { return false; }
+	auto& movement = *climber->GetCustomMovementComponent();
+
+	auto* cache = NewObject<UClimbRootMotionCache>(climber);
+	auto* animInstance = NewObject<UAnimInstance>(climber->GetMesh());
+	FClimbMovementTestAccess::SetRootMotionSetup(movement, cache, animInstance);
+
+	// nobody else simulates a local, unpossessed climber, it keeps the montage and its motion warping
+	TestFalse(TEXT("local climber plays montages"), FClimbMovementTestAccess::ShouldUseBakedRootMotion(movement));
+
+	// the owning client of a networked player must take the same path the server takes for it
+	climber->SetRole(ROLE_AutonomousProxy);
+	TestTrue(TEXT("autonomous proxy uses the baked curves"), FClimbMovementTestAccess::ShouldUseBakedRootMotion(movement));
+	TestTrue(TEXT("autonomous proxy still loads montages to pose the mesh"), FClimbMovementTestAccess::NeedsClimbMontages(movement));
+
+	climber->SetRole(ROLE_Authority);
+	FClimbMovementTestAccess::SetRootMotionSetup(movement, nullptr, animInstance);
+	TestFalse(TEXT("without a cache everyone falls back to montages"), FClimbMovementTestAccess::ShouldUseBakedRootMotion(movement));
+
+	FClimbMovementTestAccess::SetRootMotionSetup(movement, nullptr, nullptr);
+	return true;
+}
+
+#endif
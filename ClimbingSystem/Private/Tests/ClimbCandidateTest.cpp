@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace {
+	constexpr float IndexCellSize = 10.f;
+	constexpr float TargetTolerance = 1.f;
+	constexpr float WallFrontX = 95.f;
+	// tall enough for the vault start probe to land on, well short of the eye trace
+	constexpr float ObstacleHeight = 120.f;
+
+	void TestCandidatesMatch(FAutomationTestBase& test, const FString& context, const FClimbActionCandidates& candidates, const FClimbActionCandidates& expected) {
+		test.TestEqual(*FString::Printf(TEXT("%s: bCanHopUp"), *context), candidates.bCanHopUp, expected.bCanHopUp);
+		test.TestEqual(*FString::Printf(TEXT("%s: bCanHopDown"), *context), candidates.bCanHopDown, expected.bCanHopDown);
+		test.TestEqual(*FString::Printf(TEXT("%s: bCanStartClimbing"), *context), candidates.bCanStartClimbing, expected.bCanStartClimbing);
+		test.TestEqual(*FString::Printf(TEXT("%s: bCanClimbDown"), *context), candidates.bCanClimbDown, expected.bCanClimbDown);
+		test.TestEqual(*FString::Printf(TEXT("%s: bCanVault"), *context), candidates.bCanVault, expected.bCanVault);
+
+		if(expected.bCanHopUp && candidates.bCanHopUp) {
+			test.TestEqual(*FString::Printf(TEXT("%s: HopUpTarget"), *context), candidates.HopUpTarget, expected.HopUpTarget, TargetTolerance);
+		}
+		if(expected.bCanHopDown && candidates.bCanHopDown) {
+			test.TestEqual(*FString::Printf(TEXT("%s: HopDownTarget"), *context), candidates.HopDownTarget, expected.HopDownTarget, TargetTolerance);
+		}
+		if(expected.bCanVault && candidates.bCanVault) {
+			test.TestEqual(*FString::Printf(TEXT("%s: VaultStart"), *context), candidates.VaultStart, expected.VaultStart, TargetTolerance);
+			test.TestEqual(*FString::Printf(TEXT("%s: VaultLand"), *context), candidates.VaultLand, expected.VaultLand, TargetTolerance);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbCandidateAgreementTest, "ClimbingSystem.Candidates.MatchSynchronousChecks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbCandidateAgreementTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world and engine cube"), testWorld.IsValid())) { return false; }
+
+	// a wall to climb and a block to vault, far enough apart that each pose only sees its own
+	testWorld.SpawnBlock(FVector(0.f, 0.f, -50.f), FVector(4000.f, 4000.f, 100.f));
+	testWorld.SpawnBlock(FVector(WallFrontX + 25.f, 0.f, 300.f), FVector(50.f, 400.f, 600.f));
+	testWorld.SpawnBlock(FVector(200.f, -1000.f, ObstacleHeight * 0.5f), FVector(100.f, 200.f, ObstacleHeight));
+
+	auto* index = testWorld.GetWorld()->SpawnActor<AClimbSurfaceIndex>();
+	if(!TestNotNull(TEXT("surface index"), index)) { return false; }
+	FClimbSurfaceIndexTestAccess::Configure(*index, { UEngineTypes::ConvertToObjectType(ECC_WorldStatic) }, IndexCellSize,
+		FBox(FVector(-1200.f, -1200.f, -20.f), FVector(1000.f, 1200.f, 700.f)));
+	index->Bake();
+	if(!TestTrue(TEXT("index baked"), index->IsBaked())) { return false; }
+
+	testWorld.BeginPlay();
+	auto* climber = testWorld.SpawnClimber(FVector(40.f, 0.f, 97.f));
+	if(!TestNotNull(TEXT("climber"), climber)) { return false; }
+	auto& movement = *climber->GetCustomMovementComponent();
+	climber->SpawnDefaultController();
+	FClimbMovementTestAccess::SetUseClimbActionCandidates(movement, true);
+
+	// the test places the climber and drives the candidates itself, ticking would move it between request and check
+	climber->SetActorTickEnabled(false);
+	movement.SetComponentTickEnabled(false);
+
+	auto checkPose = [&](const TCHAR* pose, bool bClimbing) {
+		for(const auto bUseIndex : { false, true }) {
+			const auto context = FString::Printf(TEXT("%s, %s"), pose, bUseIndex ? TEXT("index") : TEXT("async traces"));
+			FClimbMovementTestAccess::SetUseSurfaceIndex(movement, bUseIndex);
+			if(bClimbing && !movement.IsClimbing()) {
+				movement.EnterClimbImmediately(FVector::ZeroVector);
+			}
+
+			// the index resolves on the spot, async traces come back with the next world tick
+			const auto bInFlight = FClimbMovementTestAccess::RequestClimbCandidates(movement);
+			TestEqual(*FString::Printf(TEXT("%s: traces in flight"), *context), bInFlight, !bUseIndex);
+			if(bInFlight) {
+				testWorld.Tick();
+				FClimbMovementTestAccess::ConsumeClimbCandidates(movement);
+			}
+
+			const auto* candidates = FClimbMovementTestAccess::GetFreshClimbCandidates(movement);
+			if(!TestNotNull(*FString::Printf(TEXT("%s: fresh candidates"), *context), candidates)) { continue; }
+			TestCandidatesMatch(*this, context, *candidates, FClimbMovementTestAccess::EvaluateClimbCandidates(movement));
+		}
+	};
+
+	checkPose(TEXT("facing the wall"), false);
+	TestTrue(TEXT("the wall can be climbed from in front of it"), FClimbMovementTestAccess::EvaluateClimbCandidates(movement).bCanStartClimbing);
+	checkPose(TEXT("on the wall"), true);
+
+	movement.SetMovementMode(MOVE_Walking);
+	climber->SetActorLocationAndRotation(FVector(0.f, -1000.f, 97.f), FRotator::ZeroRotator);
+	checkPose(TEXT("facing the obstacle"), false);
+	TestTrue(TEXT("the obstacle can be vaulted"), FClimbMovementTestAccess::EvaluateClimbCandidates(movement).bCanVault);
+
+	// out in the open with the index there is nothing to probe for, so candidates are not requested at all
+	climber->SetActorLocation(FVector(-800.f, 800.f, 97.f));
+	TestFalse(TEXT("no candidates requested away from climbable geometry"), FClimbMovementTestAccess::ShouldRequestClimbCandidates(movement));
+	climber->SetActorLocation(FVector(0.f, -1000.f, 97.f));
+	TestTrue(TEXT("candidates requested next to the obstacle"), FClimbMovementTestAccess::ShouldRequestClimbCandidates(movement));
+
+	return true;
+}
+
+#endif
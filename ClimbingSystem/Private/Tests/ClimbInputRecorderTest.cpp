@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Replay/ClimbInputRecorder.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	constexpr int32 NumRecordedFrames = 12;
+
+	struct FRecordedEvent {
+		uint32 Frame;
+		EClimbInputEvent Event;
+		FVector2D Value;
+	};
+
+	FVector GetPose(int32 frame, float noise) {
+		return FVector(100.f + frame * 3.1f + noise, -40.f + noise, 90.f + frame * 0.7f);
+	}
+
+	/** Drives the recorder over the same frames in both modes, replay only dispatches and never records */
+	uint32 RunFrames(FClimbInputRecorder& recorder, const TArray<FRecordedEvent>& script, float poseNoise, TArray<FRecordedEvent>& outDispatched) {
+		for(auto frame = 0; frame < NumRecordedFrames; ++frame) {
+			if(recorder.IsRecording()) {
+				for(const auto& scripted : script) {
+					if(scripted.Frame == static_cast<uint32>(frame)) {
+						recorder.Record(scripted.Event, scripted.Value);
+					}
+				}
+			}
+			recorder.DispatchFrameEvents([&](EClimbInputEvent event, const FVector2D& value) {
+				outDispatched.Add({ static_cast<uint32>(frame), event, value });
+			});
+			recorder.AdvanceFrame(GetPose(frame, poseNoise), FRotator(0.f, frame * 2.f, 0.f), frame > 6);
+		}
+		return recorder.GetChecksum();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbInputRecorderRoundTripTest, "ClimbingSystem.Replay.RecorderRoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbInputRecorderRoundTripTest::RunTest(const FString& Parameters) {
+	const auto logPath = FPaths::AutomationTransientDir() / TEXT("ClimbInputRecorderRoundTrip.clrec");
+
+	// every event type, including the jumps the hop key makes off the wall, with several on one frame
+	const TArray<FRecordedEvent> script = {
+		{ 0, EClimbInputEvent::GroundMove, FVector2D(0.f, 1.f) },
+		{ 0, EClimbInputEvent::Look, FVector2D(0.25f, -0.5f) },
+		{ 2, EClimbInputEvent::Jump, FVector2D::ZeroVector },
+		{ 3, EClimbInputEvent::Jump, FVector2D::ZeroVector },
+		{ 4, EClimbInputEvent::StopJumping, FVector2D::ZeroVector },
+		{ 6, EClimbInputEvent::ClimbAction, FVector2D::ZeroVector },
+		{ 8, EClimbInputEvent::ClimbMove, FVector2D(-1.f, 0.5f) },
+		{ 8, EClimbInputEvent::ClimbHopAction, FVector2D::ZeroVector },
+		{ 11, EClimbInputEvent::ClimbAction, FVector2D::ZeroVector }
+	};
+
+	TArray<FRecordedEvent> unused;
+	FClimbInputRecorder recorder;
+	recorder.StartRecording(logPath, 1.f / 60.f, FTransform::Identity, FRotator::ZeroRotator);
+	const auto recordedChecksum = RunFrames(recorder, script, 0.f, unused);
+	recorder.Stop();
+
+	if(!TestTrue(TEXT("replay loads the recorded log"), recorder.StartReplay(logPath))) { return false; }
+	TArray<FRecordedEvent> dispatched;
+	// poses 0.04cm off the recording are below the millimetre quantization and must not change the checksum
+	const auto replayChecksum = RunFrames(recorder, script, 0.04f, dispatched);
+	TestTrue(TEXT("replay reaches the end of the log"), recorder.IsReplayFinished());
+	recorder.Stop();
+
+	if(TestEqual(TEXT("dispatched event count"), dispatched.Num(), script.Num())) {
+		for(auto i = 0; i < script.Num(); ++i) {
+			TestEqual(*FString::Printf(TEXT("event %d frame"), i), dispatched[i].Frame, script[i].Frame);
+			TestTrue(*FString::Printf(TEXT("event %d type"), i), dispatched[i].Event == script[i].Event);
+			TestEqual(*FString::Printf(TEXT("event %d value"), i), dispatched[i].Value, script[i].Value);
+		}
+	}
+	TestEqual(TEXT("sub-millimetre noise keeps the checksum"), replayChecksum, recordedChecksum);
+
+	// two millimetres is a real behaviour change
+	TestTrue(TEXT("replay loads the recorded log again"), recorder.StartReplay(logPath));
+	dispatched.Reset();
+	TestNotEqual(TEXT("millimetre drift changes the checksum"), RunFrames(recorder, script, 0.2f, dispatched), recordedChecksum);
+	recorder.Stop();
+
+	IFileManager::Get().Delete(*logPath);
+	IFileManager::Get().Delete(*FPaths::ChangeExtension(logPath, TEXT("replay.csv")));
+	return true;
+}
+
+#endif
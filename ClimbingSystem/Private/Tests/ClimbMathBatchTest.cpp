@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Climbing/ClimbMath.h"
+#include "Climbing/ClimbMathBatch.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	constexpr int32 RandomSeed = 0x436c696d;
+	constexpr float DeltaTime = 1.f / 60.f;
+	constexpr float SnapSpeed = 100.f;
+	// the batch runs in single precision on positions made relative to the climber, the scalar path in double
+	constexpr float SnapRelativeTolerance = 1e-4f;
+	constexpr float SnapAbsoluteTolerance = 1e-3f;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbMathBatchParityTest, "ClimbingSystem.Math.BatchMatchesScalar",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbMathBatchParityTest::RunTest(const FString& Parameters) {
+	FRandomStream random(RandomSeed);
+	ClimbMath::FClimbSurfaceBatch batch;
+
+	// sizes on, below and above the lane width so the padded tail gets exercised, reusing the batch between chunks
+	for(const auto numClimbers : { 1, 3, 4, 5, 7, 16, 61 }) {
+		TArray<FVector> locations, forwards, surfaceLocations, surfaceNormals;
+		for(auto i = 0; i < numClimbers; ++i) {
+			const auto location = random.GetUnitVector() * random.FRandRange(0.f, 500000.f);
+			auto normal = random.GetUnitVector();
+			// the stop threshold is inclusive, put exact and just-below values in every chunk
+			if(i % 5 == 0) {
+				normal = FVector(FMath::Sqrt(0.75f), 0.f, 0.5f);
+			} else if(i % 5 == 1) {
+				normal = FVector(FMath::Sqrt(0.75f), 0.f, 0.5f - 1e-6f);
+			}
+
+			locations.Add(location);
+			forwards.Add(random.GetUnitVector());
+			surfaceLocations.Add(location + random.GetUnitVector() * random.FRandRange(0.f, 200.f));
+			surfaceNormals.Add(normal);
+		}
+
+		batch.Reset(numClimbers);
+		for(auto i = 0; i < numClimbers; ++i) {
+			batch.SetClimber(i, locations[i], forwards[i], surfaceLocations[i], surfaceNormals[i]);
+		}
+		batch.ComputeShouldStop();
+		batch.ComputeSnapDeltas(DeltaTime, SnapSpeed);
+
+		TestEqual(FString::Printf(TEXT("batch of %d climbers"), numClimbers), batch.Num(), numClimbers);
+		for(auto i = 0; i < numClimbers; ++i) {
+			const auto context = FString::Printf(TEXT("batch of %d, climber %d"), numClimbers, i);
+
+			TestEqual(*FString::Printf(TEXT("%s: stop with normal Z %.7f"), *context, surfaceNormals[i].Z),
+				batch.ShouldStop(i), ClimbMath::ShouldStopClimbing(surfaceNormals[i]));
+
+			const auto expected = ClimbMath::ComputeSnapDelta(locations[i], forwards[i], surfaceLocations[i], surfaceNormals[i], DeltaTime, SnapSpeed);
+			const auto actual = batch.GetSnapDelta(i);
+			const auto tolerance = SnapAbsoluteTolerance + SnapRelativeTolerance * expected.Size();
+			TestTrue(*FString::Printf(TEXT("%s: snap delta %s vs %s"), *context, *actual.ToString(), *expected.ToString()),
+				actual.Equals(expected, tolerance));
+		}
+
+		// padding lanes are zeroed, so they must never read as a climber that wants to stop
+		for(auto i = numClimbers; i < Align(numClimbers, ClimbMath::FClimbSurfaceBatch::LaneWidth); ++i) {
+			TestFalse(*FString::Printf(TEXT("batch of %d, padding lane %d does not stop"), numClimbers, i), batch.ShouldStop(i));
+		}
+	}
+
+	TestTrue(TEXT("boundary normal stops"), ClimbMath::ShouldStopClimbing(FVector(FMath::Sqrt(0.75f), 0.f, 0.5f)));
+	return true;
+}
+
+#endif
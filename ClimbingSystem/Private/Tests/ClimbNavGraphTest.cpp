@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Climbing/ClimbNavGraph.h"
+#include "Climbing/ClimbNavArea.h"
+#include "Async/ParallelFor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace {
+	constexpr float IndexCellSize = 10.f;
+	constexpr float CostTolerance = 1e-3f;
+	constexpr int32 NumParallelQueries = 64;
+
+	bool StepsMatch(const TArray<FClimbNavStep>& a, const TArray<FClimbNavStep>& b) {
+		if(a.Num() != b.Num()) { return false; }
+		for(auto i = 0; i < a.Num(); ++i) {
+			if(a[i].Action != b[i].Action || !a[i].Location.Equals(b[i].Location)) { return false; }
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbNavGraphPathTest, "ClimbingSystem.NavGraph.PathFollowsClimberLimits",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbNavGraphPathTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world and engine cube"), testWorld.IsValid())) { return false; }
+
+	// a 4m wall with a walkable top, face at x = 100
+	testWorld.SpawnBlock(FVector(0.f, 0.f, -50.f), FVector(3000.f, 3000.f, 100.f));
+	testWorld.SpawnBlock(FVector(150.f, 0.f, 200.f), FVector(100.f, 600.f, 400.f));
+
+	auto* index = testWorld.GetWorld()->SpawnActor<AClimbSurfaceIndex>();
+	if(!TestNotNull(TEXT("surface index"), index)) { return false; }
+	FClimbSurfaceIndexTestAccess::Configure(*index, { UEngineTypes::ConvertToObjectType(ECC_WorldStatic) }, IndexCellSize,
+		FBox(FVector(-200.f, -400.f, -20.f), FVector(300.f, 400.f, 500.f)));
+	index->Bake();
+	if(!TestTrue(TEXT("index baked"), index->IsBaked())) { return false; }
+
+	auto* graph = testWorld.GetWorld()->SpawnActor<AClimbNavGraph>();
+	if(!TestNotNull(TEXT("nav graph"), graph)) { return false; }
+	graph->Bake();
+	if(!TestTrue(TEXT("graph baked"), graph->IsBaked())) { return false; }
+
+	// edges are priced and limited by the default climber's own movement settings, not numbers kept on the graph
+	const auto traversal = GetDefault<AClimbingSystemCharacter>()->GetCustomMovementComponent()->GetNavTraversalParams();
+	const auto& nodes = graph->GetNodes();
+	for(auto i = 0; i < nodes.Num(); ++i) {
+		for(const auto& edge : graph->GetEdges(i)) {
+			const auto delta = nodes[edge.To].Anchor - nodes[i].Anchor;
+			const auto context = FString::Printf(TEXT("edge %d -> %d"), i, edge.To);
+			switch(edge.Action) {
+				case EClimbNavAction::Climb:
+					TestEqual(*FString::Printf(TEXT("%s: climb cost at MaxClimbSpeed"), *context), edge.Cost, static_cast<float>(delta.Size()) / traversal.ClimbSpeed, CostTolerance);
+					break;
+				case EClimbNavAction::HopUp:
+					TestTrue(*FString::Printf(TEXT("%s: hop up of %.0f within ClimbHopUpReach"), *context, delta.Z), delta.Z <= traversal.HopUpReach);
+					break;
+				case EClimbNavAction::HopDown:
+					TestTrue(*FString::Printf(TEXT("%s: hop down of %.0f within ClimbHopDownReach"), *context, -delta.Z), -delta.Z <= traversal.HopDownReach);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	const auto floor = FVector(50.f, 0.f, 96.f);
+	const auto top = FVector(150.f, 0.f, 496.f);
+	TArray<FClimbNavStep> upSteps, downSteps;
+	if(!TestTrue(TEXT("path from the floor to the top of the wall"), graph->FindClimbPath(floor, top, upSteps))) { return false; }
+	TestTrue(TEXT("path starts by moving to its first node"), upSteps[0].Action == EClimbNavAction::Move);
+	TestTrue(TEXT("path starts climbing"), upSteps.ContainsByPredicate([](const FClimbNavStep& step) { return step.Action == EClimbNavAction::StartClimbing; }));
+	TestTrue(TEXT("path ends climbing onto the top"), upSteps.Last().Action == EClimbNavAction::ClimbUp);
+	TestTrue(TEXT("path back down from the top"), graph->FindClimbPath(top, floor, downSteps));
+
+	// a couple of cells off the nearest node still snaps onto the graph, the far side of the level does not
+	TArray<FClimbNavStep> offGraphSteps;
+	TestTrue(TEXT("path from a start a few cells off the graph"), graph->FindClimbPath(FVector(-100.f, 0.f, 96.f), top, offGraphSteps));
+	TestEqual(TEXT("no node within snapping distance of the far side of the level"), graph->FindNearestNode(FVector(-2000.f, 0.f, 96.f)), INDEX_NONE);
+
+	// path following only climbs across links of its own area
+	TArray<FNavigationLink> navLinks;
+	TArray<FNavigationSegmentLink> navSegments;
+	if(TestTrue(TEXT("floor to top routes published as nav links"), graph->GetNavigationLinksArray(navLinks, navSegments))) {
+		for(const auto& link : navLinks) {
+			TestTrue(TEXT("nav link uses UClimbNavArea"), link.GetAreaClass() == UClimbNavArea::StaticClass());
+		}
+	}
+
+	// workers search at the same time as each other, each has to come back with the game thread's route
+	TArray<TArray<FClimbNavStep>> parallelSteps;
+	parallelSteps.SetNum(NumParallelQueries);
+	ParallelFor(NumParallelQueries, [&](int32 i) {
+		const auto bUp = i % 2 == 0;
+		graph->FindClimbPath(bUp ? floor : top, bUp ? top : floor, parallelSteps[i]);
+	});
+	for(auto i = 0; i < NumParallelQueries; ++i) {
+		TestTrue(*FString::Printf(TEXT("parallel query %d matches the game thread"), i), StepsMatch(parallelSteps[i], i % 2 == 0 ? upSteps : downSteps));
+	}
+
+	return true;
+}
+
+#endif
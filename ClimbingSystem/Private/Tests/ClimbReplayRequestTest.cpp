@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbReplayRequestTest, "ClimbingSystem.Networking.ReplayAppliesSavedRequests",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbReplayRequestTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world and engine cube"), testWorld.IsValid())) { return false; }
+
+	testWorld.SpawnBlock(FVector(0.f, 0.f, -50.f), FVector(2000.f, 2000.f, 100.f));
+	testWorld.SpawnBlock(FVector(120.f, 0.f, 300.f), FVector(50.f, 400.f, 600.f));
+	testWorld.BeginPlay();
+
+	auto* climber = testWorld.SpawnClimber(FVector(40.f, 0.f, 100.f));
+	if(!TestNotNull(TEXT("climber"), climber)) { return false; }
+	auto& movement = *climber->GetCustomMovementComponent();
+	FClimbMovementTestAccess::SetUseSurfaceIndex(movement, false);
+
+	auto* clientData = movement.GetPredictionData_Client_Character();
+	if(!TestNotNull(TEXT("client prediction data"), clientData)) { return false; }
+
+	// the player asks to climb, the move carrying the request runs and is still unacknowledged when a correction arrives
+	movement.ToggleClimbing(true);
+	auto climbMove = clientData->AllocateNewMove();
+	climbMove->SetMoveFor(climber, 1.f / 60.f, FVector::ZeroVector, *clientData);
+	TestTrue(TEXT("the saved move carries the climb request"), (climbMove->GetCompressedFlags() & FSavedMove_Climb::FLAG_Climb) != 0);
+	FClimbMovementTestAccess::ProcessClimbRequests(movement);
+	clientData->SavedMoves.Add(climbMove);
+
+	// a request made after that move has no saved move yet
+	movement.RequestHopping();
+	movement.ResetPerfCounters();
+
+	clientData->bUpdatePosition = true;
+	FClimbMovementTestAccess::ReplaySavedMoves(movement);
+
+	TestFalse(TEXT("the replay is over"), climber->bClientUpdating);
+#if CLIMB_PERF_COUNTERS
+	TestTrue(TEXT("the replayed move traces for its climb entry again"), movement.GetPerfCounters().NumSceneQueries > 0u);
+#endif
+	TestTrue(TEXT("the live request survives the replay"), FClimbMovementTestAccess::HasPendingClimbRequest(movement));
+
+	FClimbMovementTestAccess::ProcessClimbRequests(movement);
+	TestFalse(TEXT("the next new move consumes the live request"), FClimbMovementTestAccess::HasPendingClimbRequest(movement));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Climbing/ClimbMath.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace {
+	// snap deltas are compared as the raw depth to the wall, so this is in cm
+	constexpr float SnapTolerance = 1.f;
+	constexpr float NormalTolerance = 0.99f;
+	constexpr float IndexCellSize = 10.f;
+	// off the bake's sample grid, so the top edge cell gets samples of both the wall face and the walkable top
+	constexpr float WallTop = 607.f;
+	constexpr float WallFrontX = 93.f;
+	// sample heights from a capsule just clear of the floor up to one whose top is past the ledge
+	const float SampleHeights[] = { 80.f, 100.f, 165.f, 210.f, 255.f, 300.f, 345.f, 390.f, 435.f, 480.f, 540.f, 560.f };
+
+	struct FSurfaceSample {
+		FVector SnapDelta = FVector::ZeroVector;
+		FVector Normal = FVector::ZeroVector;
+		bool bHit = false;
+	};
+
+	FSurfaceSample SampleSurface(AClimbingSystemCharacter& climber) {
+		auto& movement = *climber.GetCustomMovementComponent();
+
+		FSurfaceSample sample;
+		sample.bHit = FClimbMovementTestAccess::TraceClimbableSurfaces(movement);
+		if(!sample.bHit) { return sample; }
+
+		FVector surfaceLocation;
+		FClimbMovementTestAccess::ProcessClimbableSurfaces(movement, surfaceLocation, sample.Normal);
+		// a one second step at unit speed turns the snap delta into the full distance PhysClimb would close
+		sample.SnapDelta = ClimbMath::ComputeSnapDelta(climber.GetActorLocation(), climber.GetActorForwardVector(), surfaceLocation, sample.Normal, 1.f, 1.f);
+		return sample;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbSurfaceIndexSnapTest, "ClimbingSystem.SurfaceIndex.SnapMatchesLiveTraces",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbSurfaceIndexSnapTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world and engine cube"), testWorld.IsValid())) { return false; }
+
+	// an upright wall, one leaning back 15 degrees so the index has to reproduce planes that are not on a cell axis, and
+	// one thinner than a cell so both of its faces land in the same cells
+	testWorld.SpawnBlock(FVector(0.f, 0.f, -50.f), FVector(3000.f, 3000.f, 100.f));
+	testWorld.SpawnBlock(FVector(WallFrontX + 25.f, 0.f, WallTop * 0.5f), FVector(50.f, 400.f, WallTop));
+	testWorld.SpawnBlock(FVector(140.f, 800.f, WallTop * 0.5f), FVector(50.f, 400.f, WallTop), FRotator(-15.f, 0.f, 0.f));
+	testWorld.SpawnBlock(FVector(93.5f, -800.f, WallTop * 0.5f), FVector(5.f, 400.f, WallTop));
+
+	auto* index = testWorld.GetWorld()->SpawnActor<AClimbSurfaceIndex>();
+	if(!TestNotNull(TEXT("surface index"), index)) { return false; }
+	FClimbSurfaceIndexTestAccess::Configure(*index, { UEngineTypes::ConvertToObjectType(ECC_WorldStatic) }, IndexCellSize,
+		FBox(FVector(-200.f, -1200.f, -20.f), FVector(400.f, 1200.f, 700.f)));
+	index->Bake();
+	if(!TestTrue(TEXT("index baked"), index->IsBaked())) { return false; }
+
+	// a cell holding both sides of the thin wall keeps each as its own face instead of a cancelled-out normal
+	for(const auto& face : index->GetCells()) {
+		TestFalse(*FString::Printf(TEXT("face in cell %s has a normal"), *AClimbSurfaceIndex::UnpackCellKey(face.Key).ToString()), face.Normal.IsNearlyZero());
+	}
+	const auto thinWallFaces = index->FindCellFaces(index->ToCellCoord(FVector(93.5f, -800.f, 300.f)));
+	TestTrue(TEXT("thin wall cell keeps its front face"), thinWallFaces.ContainsByPredicate([](const FClimbSurfaceCell& face) {
+		return face.Normal.X <= -NormalTolerance && face.HasAnyFlags(EClimbSurfaceCellFlags::Climbable);
+	}));
+	TestTrue(TEXT("thin wall cell keeps its back face"), thinWallFaces.ContainsByPredicate([](const FClimbSurfaceCell& face) {
+		return face.Normal.X >= NormalTolerance && face.HasAnyFlags(EClimbSurfaceCellFlags::Climbable);
+	}));
+
+	// the cell on the wall's top edge holds the climbable face and the walkable top, not one chamfer between them
+	const auto edgeFaces = index->FindCellFaces(index->ToCellCoord(FVector(WallFrontX + 3.f, 0.f, WallTop - 2.f)));
+	TestTrue(TEXT("top edge keeps the wall face"), edgeFaces.ContainsByPredicate([](const FClimbSurfaceCell& face) {
+		return face.Normal.X <= -NormalTolerance && face.HasAnyFlags(EClimbSurfaceCellFlags::Climbable);
+	}));
+	TestTrue(TEXT("top edge keeps the walkable top"), edgeFaces.ContainsByPredicate([](const FClimbSurfaceCell& face) {
+		return face.Normal.Z >= NormalTolerance && face.HasAnyFlags(EClimbSurfaceCellFlags::Walkable);
+	}));
+	TestFalse(TEXT("top edge has no chamfered face"), edgeFaces.ContainsByPredicate([](const FClimbSurfaceCell& face) {
+		return face.Normal.X > -NormalTolerance && face.Normal.Z < NormalTolerance;
+	}));
+
+	testWorld.BeginPlay();
+
+	auto* climber = testWorld.SpawnClimber(FVector(40.f, 0.f, 100.f));
+	if(!TestNotNull(TEXT("climber"), climber)) { return false; }
+	auto& movement = *climber->GetCustomMovementComponent();
+
+	auto numCompared = 0;
+	for(const auto wallY : { 0.f, 800.f, -800.f }) {
+		// the leaning wall drifts out of reach as the climber rises, the upright ones are in range from every pose
+		const auto bAlwaysInReach = wallY != 800.f;
+		for(auto offsetY = -120.f; offsetY <= 120.f; offsetY += 37.f) {
+			for(const auto height : SampleHeights) {
+				for(const auto yaw : { -20.f, 0.f, 25.f }) {
+					climber->SetActorLocationAndRotation(FVector(40.f, wallY + offsetY, height), FRotator(0.f, yaw, 0.f));
+
+					FClimbMovementTestAccess::SetUseSurfaceIndex(movement, false);
+					const auto live = SampleSurface(*climber);
+					FClimbMovementTestAccess::SetUseSurfaceIndex(movement, true);
+					const auto indexed = SampleSurface(*climber);
+
+					const auto context = FString::Printf(TEXT("wall %.0f at (%.0f, %.0f) yaw %.0f"), wallY, offsetY, height, yaw);
+					if(bAlwaysInReach) {
+						TestTrue(*FString::Printf(TEXT("%s: both sweeps find the wall"), *context), live.bHit && indexed.bHit);
+					}
+					if(!live.bHit || !indexed.bHit) { continue; }
+
+					TestTrue(*FString::Printf(TEXT("%s: snap delta %s vs %s"), *context, *indexed.SnapDelta.ToString(), *live.SnapDelta.ToString()),
+						indexed.SnapDelta.Equals(live.SnapDelta, SnapTolerance));
+					TestTrue(*FString::Printf(TEXT("%s: surface normal %s vs %s"), *context, *indexed.Normal.ToString(), *live.Normal.ToString()),
+						FVector::DotProduct(indexed.Normal, live.Normal) >= NormalTolerance);
+					++numCompared;
+				}
+			}
+		}
+	}
+	TestTrue(TEXT("climber reached the walls from some of the sample poses"), numCompared > 0);
+
+	// line traces at steep diagonals cross cells corner to corner, which is where a fixed step march can skip one
+	const auto eye = FVector(0.f, 0.f, 250.f);
+	for(auto pitch = -40.f; pitch <= 40.f; pitch += 10.f) {
+		for(auto yaw = -50.f; yaw <= 50.f; yaw += 10.f) {
+			const auto end = eye + FRotator(pitch, yaw, 0.f).Vector() * 400.f;
+
+			FClimbMovementTestAccess::SetUseSurfaceIndex(movement, false);
+			const auto live = FClimbMovementTestAccess::LineTrace(movement, eye, end);
+			FClimbMovementTestAccess::SetUseSurfaceIndex(movement, true);
+			const auto indexed = FClimbMovementTestAccess::LineTrace(movement, eye, end);
+
+			const auto context = FString::Printf(TEXT("line pitch %.0f yaw %.0f"), pitch, yaw);
+			if(!TestEqual(*FString::Printf(TEXT("%s: index hits when the live trace does"), *context), indexed.bBlockingHit, live.bBlockingHit) || !live.bBlockingHit) { continue; }
+
+			TestTrue(*FString::Printf(TEXT("%s: impact %s vs %s"), *context, *indexed.ImpactPoint.ToString(), *live.ImpactPoint.ToString()),
+				indexed.ImpactPoint.Equals(live.ImpactPoint, SnapTolerance));
+		}
+	}
+
+	return true;
+}
+
+#endif
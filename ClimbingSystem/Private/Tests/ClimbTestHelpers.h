@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "ClimbingSystem/ClimbingSystemCharacter.h"
+#include "Climbing/ClimbRootMotionCache.h"
+#include "Climbing/ClimbSurfaceIndex.h"
+#include "Components/CustomMovementComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/MemoryBase.h"
+
+/** Reaches the movement component's private climb internals from the automation tests */
+struct FClimbMovementTestAccess {
+	static void SetClimbTraceTypes(UCustomMovementComponent& movement, const TArray<TEnumAsByte<EObjectTypeQuery>>& traceTypes) {
+		movement.ClimableSurfaceTraceTypes = traceTypes;
+		movement.InitClimbQueryParams();
+	}
+
+	static void SetUseSurfaceIndex(UCustomMovementComponent& movement, bool bUseIndex) {
+		movement.bUseBakedSurfaceIndex = bUseIndex;
+		movement.FindSurfaceIndex();
+	}
+
+	static bool SweepCapsule(UCustomMovementComponent& movement, const FVector& start, const FVector& end, TArray<FHitResult>& outHits) {
+		return movement.DoCapsuleTraceMultiByObject(start, end, outHits, EClimbDebugCategory::Surface);
+	}
+
+	static FHitResult LineTrace(UCustomMovementComponent& movement, const FVector& start, const FVector& end) {
+		return movement.DoLineTraceSingleByObject(start, end, EClimbDebugCategory::EyeHeight);
+	}
+
+	static bool TraceClimbableSurfaces(UCustomMovementComponent& movement) {
+		movement.InvalidateSurfaceCache();
+		return movement.TraceClimbableSurfaces();
+	}
+
+	static FHitResult TraceFromEyeHeight(UCustomMovementComponent& movement, float traceDistance) {
+		return movement.TraceFromEyeHeight(traceDistance);
+	}
+
+	static FTraceHandle RequestAsyncCapsuleTrace(UCustomMovementComponent& movement, const FVector& start, const FVector& end) {
+		return movement.RequestAsyncCapsuleTrace(start, end);
+	}
+
+	static FTraceHandle RequestAsyncLineTrace(UCustomMovementComponent& movement, const FVector& start, const FVector& end) {
+		return movement.RequestAsyncLineTrace(start, end);
+	}
+
+	static bool ConsumeAsyncTrace(UCustomMovementComponent& movement, FTraceHandle& handle, TArray<FHitResult>& outHits) {
+		return movement.ConsumeAsyncTrace(handle, outHits);
+	}
+
+	static void UpdateFromCompressedFlags(UCustomMovementComponent& movement, uint8 flags) {
+		movement.UpdateFromCompressedFlags(flags);
+	}
+
+	static void ProcessClimbRequests(UCustomMovementComponent& movement) {
+		movement.ProcessClimbRequests();
+	}
+
+	/** Replays the client's unacknowledged saved moves the way a server correction does */
+	static bool ReplaySavedMoves(UCustomMovementComponent& movement) {
+		return movement.ClientUpdatePositionAfterServerUpdate();
+	}
+
+	static void SetUseClimbActionCandidates(UCustomMovementComponent& movement, bool bUseCandidates) {
+		movement.bUseClimbActionCandidates = bUseCandidates;
+	}
+
+	static bool ShouldRequestClimbCandidates(UCustomMovementComponent& movement) {
+		movement.lastCandidateRequestTime = -1.f;
+		return movement.ShouldRequestClimbCandidates();
+	}
+
+	/** True while the candidates' traces are still in flight, ConsumeClimbCandidates picks them up after the world ticks */
+	static bool RequestClimbCandidates(UCustomMovementComponent& movement) {
+		movement.RequestClimbCandidates();
+		return !movement.candidateTraceHandles.IsEmpty();
+	}
+
+	static void ConsumeClimbCandidates(UCustomMovementComponent& movement) {
+		movement.ConsumeClimbCandidates();
+	}
+
+	static const FClimbActionCandidates* GetFreshClimbCandidates(const UCustomMovementComponent& movement) {
+		return movement.GetFreshClimbCandidates();
+	}
+
+	/** What the actions decide when they trace on the spot */
+	static FClimbActionCandidates EvaluateClimbCandidates(UCustomMovementComponent& movement) {
+		FClimbActionCandidates candidates;
+		candidates.bClimbing = movement.IsClimbing();
+		movement.EvaluateClimbCandidates(candidates);
+		return candidates;
+	}
+
+	static bool HasPendingClimbRequest(const UCustomMovementComponent& movement) {
+		return movement.bWantsToClimb || movement.bWantsToStopClimbing || movement.bWantsToHop || movement.bWantsToVault;
+	}
+
+	static void SetRootMotionSetup(UCustomMovementComponent& movement, UClimbRootMotionCache* cache, UAnimInstance* animInstance) {
+		movement.RootMotionCache = cache;
+		movement.owningPlayerAnimInstance = animInstance;
+	}
+
+	static bool ShouldUseBakedRootMotion(const UCustomMovementComponent& movement) {
+		return movement.ShouldUseBakedRootMotion();
+	}
+
+	static bool NeedsClimbMontages(const UCustomMovementComponent& movement) {
+		return movement.NeedsClimbMontages();
+	}
+
+	/** Runs the same surface reduction PhysClimb does and returns where it would snap to */
+	static void ProcessClimbableSurfaces(UCustomMovementComponent& movement, FVector& outLocation, FVector& outNormal) {
+		movement.processClimbableSurfaceInfo();
+		outLocation = movement.currentClimbableSurfaceLocation;
+		outNormal = movement.currentClimbableSurfaceNormal;
+	}
+};
+
+/** Sets up a surface index the way a level designer would before pressing Bake */
+struct FClimbSurfaceIndexTestAccess {
+	static void Configure(AClimbSurfaceIndex& index, const TArray<TEnumAsByte<EObjectTypeQuery>>& traceTypes, float cellSize, const FBox& bakeBounds) {
+		index.SurfaceTraceTypes = traceTypes;
+		index.CellSize = cellSize;
+		index.BakeBounds = bakeBounds;
+	}
+};
+
+namespace ClimbTests {
+	/** Game world built from engine cubes, destroyed with the scope */
+	class FTestWorld {
+	public:
+		FTestWorld() {
+			world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ClimbTestWorld"));
+			auto& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			worldContext.SetCurrentWorld(world);
+			world->InitializeActorsForPlay(FURL());
+			cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		}
+
+		~FTestWorld() {
+			GEngine->DestroyWorldContext(world);
+			world->DestroyWorld(false);
+		}
+
+		void BeginPlay() {
+			world->GetWorldSettings()->NotifyBeginPlay();
+			world->GetWorldSettings()->NotifyMatchStarted();
+		}
+
+		AStaticMeshActor* SpawnBlock(const FVector& center, const FVector& sizeInCm, const FRotator& rotation = FRotator::ZeroRotator) {
+			if(!cube) { return nullptr; }
+
+			// the engine cube is 100cm on a side
+			const FTransform transform(rotation, center, sizeInCm / 100.f);
+			auto* block = world->SpawnActorDeferred<AStaticMeshActor>(AStaticMeshActor::StaticClass(), transform);
+			if(!block) { return nullptr; }
+
+			block->GetStaticMeshComponent()->SetStaticMesh(cube);
+			block->GetStaticMeshComponent()->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			block->FinishSpawning(transform);
+			return block;
+		}
+
+		AClimbingSystemCharacter* SpawnClimber(const FVector& location, const FRotator& rotation = FRotator::ZeroRotator) {
+			FActorSpawnParameters spawnParams;
+			spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			auto* climber = world->SpawnActor<AClimbingSystemCharacter>(AClimbingSystemCharacter::StaticClass(), location, rotation, spawnParams);
+			if(climber) {
+				// cubes are WorldStatic, the component's own default is left to the blueprint
+				FClimbMovementTestAccess::SetClimbTraceTypes(*climber->GetCustomMovementComponent(), { UEngineTypes::ConvertToObjectType(ECC_WorldStatic) });
+			}
+			return climber;
+		}
+
+		void Tick(int32 frames = 1, float deltaTime = 1.f / 60.f) {
+			for(auto i = 0; i < frames; ++i) {
+				world->Tick(LEVELTICK_All, deltaTime);
+				++GFrameCounter;
+			}
+		}
+
+		FORCEINLINE UWorld* GetWorld() const { return world; }
+		FORCEINLINE bool IsValid() const { return world && cube; }
+
+	private:
+		UWorld* world = nullptr;
+		UStaticMesh* cube = nullptr;
+	};
+
+	/**
+	 * Counts heap allocations made by the calling thread while in scope. GMalloc is swapped for a forwarding
+	 * proxy, so memory allocated inside the scope can still be freed after it.
+	 */
+	class FAllocationCounter : public FMalloc {
+	public:
+		FAllocationCounter() : inner(GMalloc), ownerThreadId(FPlatformTLS::GetCurrentThreadId()) {
+			GMalloc = this;
+		}
+
+		~FAllocationCounter() {
+			GMalloc = inner;
+		}
+
+		void* Malloc(SIZE_T count, uint32 alignment) override {
+			countAllocation();
+			return inner->Malloc(count, alignment);
+		}
+
+		void* TryMalloc(SIZE_T count, uint32 alignment) override {
+			countAllocation();
+			return inner->TryMalloc(count, alignment);
+		}
+
+		void* Realloc(void* original, SIZE_T count, uint32 alignment) override {
+			if(count > 0) {
+				countAllocation();
+			}
+			return inner->Realloc(original, count, alignment);
+		}
+
+		void* TryRealloc(void* original, SIZE_T count, uint32 alignment) override {
+			if(count > 0) {
+				countAllocation();
+			}
+			return inner->TryRealloc(original, count, alignment);
+		}
+
+		void Free(void* original) override { inner->Free(original); }
+		bool GetAllocationSize(void* original, SIZE_T& outSize) override { return inner->GetAllocationSize(original, outSize); }
+		SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return inner->QuantizeSize(count, alignment); }
+		void Trim(bool bTrimThreadCaches) override { inner->Trim(bTrimThreadCaches); }
+		bool IsInternallyThreadSafe() const override { return inner->IsInternallyThreadSafe(); }
+		const TCHAR* GetDescriptiveName() override { return TEXT("ClimbAllocationCounter"); }
+
+		/** Only allocations between Begin and End are counted, so setup inside the scope stays out of the total */
+		void Begin() { bCounting = true; }
+		void End() { bCounting = false; }
+		FORCEINLINE int32 GetNumAllocations() const { return numAllocations; }
+
+	private:
+		void countAllocation() {
+			if(bCounting && FPlatformTLS::GetCurrentThreadId() == ownerThreadId) {
+				++numAllocations;
+			}
+		}
+
+		FMalloc* inner;
+		uint32 ownerThreadId;
+		int32 numAllocations = 0;
+		bool bCounting = false;
+	};
+}
+
+#endif
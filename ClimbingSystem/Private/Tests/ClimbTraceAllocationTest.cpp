@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Tests/ClimbTestHelpers.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+	constexpr int32 WarmUpFrames = 8;
+	constexpr int32 MeasuredFrames = 32;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbTraceAllocationTest, "ClimbingSystem.Traces.SteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FClimbTraceAllocationTest::RunTest(const FString& Parameters) {
+	ClimbTests::FTestWorld testWorld;
+	if(!TestTrue(TEXT("test world and engine cube"), testWorld.IsValid())) { return false; }
+
+	testWorld.SpawnBlock(FVector(0.f, 0.f, -50.f), FVector(2000.f, 2000.f, 100.f));
+	testWorld.SpawnBlock(FVector(120.f, 0.f, 300.f), FVector(50.f, 400.f, 600.f));
+	testWorld.BeginPlay();
+
+	auto* climber = testWorld.SpawnClimber(FVector(0.f, 0.f, 100.f));
+	if(!TestNotNull(TEXT("climber"), climber)) { return false; }
+	auto& movement = *climber->GetCustomMovementComponent();
+	// live traces only, the index has its own test
+	FClimbMovementTestAccess::SetUseSurfaceIndex(movement, false);
+
+	const auto location = climber->GetActorLocation();
+	const auto forward = climber->GetActorForwardVector();
+	TArray<FHitResult> sweepHits;
+	TArray<FHitResult> asyncHits;
+	sweepHits.Reserve(16);
+	asyncHits.Reserve(16);
+
+	// one climb tick's worth of the trace layer: surface sweep, eye trace, and an async sweep and line consumed a frame later
+	auto runTraces = [&](ClimbTests::FAllocationCounter* counter) {
+		FTraceHandle sweepHandle;
+		FTraceHandle lineHandle;
+
+		if(counter) { counter->Begin(); }
+		FClimbMovementTestAccess::TraceClimbableSurfaces(movement);
+		FClimbMovementTestAccess::TraceFromEyeHeight(movement, 100.f);
+		FClimbMovementTestAccess::SweepCapsule(movement, location, location + forward * 100.f, sweepHits);
+		FClimbMovementTestAccess::LineTrace(movement, location, location + forward * 200.f);
+		sweepHandle = FClimbMovementTestAccess::RequestAsyncCapsuleTrace(movement, location, location + forward * 100.f);
+		lineHandle = FClimbMovementTestAccess::RequestAsyncLineTrace(movement, location, location + forward * 200.f);
+		if(counter) { counter->End(); }
+
+		// the world runs the trace delegates at the start of its next tick, engine work in there is not ours to count
+		testWorld.Tick();
+
+		if(counter) { counter->Begin(); }
+		FClimbMovementTestAccess::ConsumeAsyncTrace(movement, sweepHandle, asyncHits);
+		FClimbMovementTestAccess::ConsumeAsyncTrace(movement, lineHandle, asyncHits);
+		if(counter) { counter->End(); }
+	};
+
+	for(auto i = 0; i < WarmUpFrames; ++i) {
+		runTraces(nullptr);
+	}
+	TestTrue(TEXT("the wall is in reach of the surface sweep"), FClimbMovementTestAccess::SweepCapsule(movement, location, location + forward * 100.f, sweepHits));
+
+	auto numAllocations = 0;
+	{
+		ClimbTests::FAllocationCounter counter;
+		for(auto i = 0; i < MeasuredFrames; ++i) {
+			runTraces(&counter);
+		}
+		numAllocations = counter.GetNumAllocations();
+	}
+
+	TestEqual(TEXT("heap allocations by the climb trace layer after warm up"), numAllocations, 0);
+	return true;
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Components/CustomMovementComponent.h"
 #include "CharacterAnimInstance.generated.h"
 
 class AClimbingSystemCharacter;
@@ -19,6 +20,7 @@ class CLIMBINGSYSTEM_API UCharacterAnimInstance : public UAnimInstance
 public:
 	void NativeInitializeAnimation() override;
 	void NativeUpdateAnimation(float DeltaSeconds) override;
+	void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
 
 private:
 	UPROPERTY()
@@ -27,27 +29,44 @@ private:
 	UPROPERTY()
 	UCustomMovementComponent* customMovementComp;
 
+	/** Copied from the movement component on the game thread, the only movement state the worker thread reads */
+	FClimbAnimSnapshot animSnapshot;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	float groundSpeed;
-	void GetGroundSpeed();
+	void GetGroundSpeed(const FClimbAnimSnapshot& snapshot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	float airSpeed;
-	void GetAirSpeed();
+	void GetAirSpeed(const FClimbAnimSnapshot& snapshot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	bool bShouldMove;
-	void GetShouldMove();
+	void GetShouldMove(const FClimbAnimSnapshot& snapshot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	bool bIsFalling;
-	void GetIsFalling();
+	void GetIsFalling(const FClimbAnimSnapshot& snapshot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	bool bIsClimbing;
-	void GetIsClimbing();
+	void GetIsClimbing(const FClimbAnimSnapshot& snapshot);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference", meta = (AllowPrivateAccess = "true"))
 	FVector climbVelocity;
-	void GetClimbVelocity();
+	void GetClimbVelocity(const FClimbAnimSnapshot& snapshot);
+
+	/** World space effectors and alphas for the hand and foot two bone IK nodes */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference|IK", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIKTarget leftHandIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference|IK", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIKTarget rightHandIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference|IK", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIKTarget leftFootIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Reference|IK", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIKTarget rightFootIK;
+	void GetLimbIK(const FClimbAnimSnapshot& snapshot);
 };
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClimbBenchmarkCommandlet.generated.h"
+
+class AClimbingSystemCharacter;
+class FJsonObject;
+class UCustomMovementComponent;
+
+/**
+ * Headless climbing benchmark. Builds a procedural course, drives N climbers with scripted input and writes a JSON report.
+ *
+ * UnrealEditor-Cmd <Project> -run=ClimbBenchmark -nullrhi -unattended
+ *     [-Climbers=32] [-Frames=1800] [-FixedDeltaTime=0.0166667]
+ *     [-CharacterClass=/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C]
+ *     [-Output=<Saved>/Benchmarks/ClimbBenchmark.json] [-MaxPhysClimbMs=0] [-VaultProbes=1000] [-InputSwitches=1000]
+ *     [-QueryBatches=300] [-QueryBatchSpacing=100]
+ *
+ * After the scripted run, climbers on vault lanes are parked in front of their obstacle and probed -VaultProbes times with the
+ * component's vault detector and with the original five-trace loop, reporting queries and latency per probe for both.
+ * The first climber's input is then switched in and out of climb mode -InputSwitches times, once by adding and removing its
+ * climb mapping context as it used to and once through the mode flag it uses now, reporting the cost per switch for both.
+ * Last, every climber is hung on the first wall -QueryBatchSpacing cm from its neighbours and UClimbQuerySubsystem runs
+ * -QueryBatches batches of their queries serially and in parallel, reporting the duplicate rate and the parallel speedup.
+ * Returns non-zero when the run fails or the average PhysClimb cost exceeds -MaxPhysClimbMs, so a perf gate can key off the exit code.
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UClimbBenchmarkCommandlet();
+
+	int32 Main(const FString& Params) override;
+
+private:
+	void BuildCourse(UWorld* world, int32 numLanes) const;
+	void DriveClimber(AClimbingSystemCharacter* climber, int32 climberIndex, int32 frame) const;
+	FTransform GetLaneStart(int32 laneIndex) const;
+	void MeasureVaultDetectors(const TArray<AClimbingSystemCharacter*>& climbers, int32 numProbes, FJsonObject& report) const;
+	void MeasureInputModeSwitches(AClimbingSystemCharacter& climber, int32 numSwitches, FJsonObject& report) const;
+	void MeasureQueryBatch(const TArray<AClimbingSystemCharacter*>& climbers, int32 numBatches, float spacing, FJsonObject& report) const;
+
+	/** CanStartVaulting as it was before the two-probe detector, kept only as the benchmark's baseline */
+	static bool LegacyCanStartVaulting(UCustomMovementComponent& movement, FVector& outVaultStartPosition, FVector& outVaultLandPosition);
+};
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "ClimbAIController.generated.h"
+
+/** AI controller whose path following climbs across AClimbNavGraph's navmesh links */
+UCLASS()
+class CLIMBINGSYSTEM_API AClimbAIController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AClimbAIController(const FObjectInitializer& ObjectInitializer);
+};
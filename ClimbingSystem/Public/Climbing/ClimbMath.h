@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+
+/**
+ * Climb surface math shared by UCustomMovementComponent and the Mass climbing processors.
+ * Everything here is pure so it can run on any thread.
+ */
+namespace ClimbMath {
+	constexpr float ClimbRotationInterpSpeed = 5.f;
+	constexpr float MaxClimbableSurfaceAngle = 60.f;
+	/** cos(MaxClimbableSurfaceAngle), surfaces whose normal is at least this close to up are floors */
+	constexpr float MinStopClimbingDot = 0.5f;
+
+	FORCEINLINE bool ShouldStopClimbing(const FVector& surfaceNormal) {
+		// the angle test without the Acos, the dot against up is just the normal's Z
+		return surfaceNormal.Z >= MinStopClimbingDot;
+	}
+
+	/** Mean impact point and normalized summed impact normal, zero when there are no hits */
+	FORCEINLINE int32 AverageSurfaceHits(TConstArrayView<FHitResult> hits, FVector& outLocation, FVector& outNormal) {
+		outLocation = FVector::ZeroVector;
+		outNormal = FVector::ZeroVector;
+		if(hits.IsEmpty()) { return 0; }
+
+		for(const auto& hit : hits) {
+			outLocation += hit.ImpactPoint;
+			outNormal += hit.ImpactNormal;
+		}
+		outLocation /= hits.Num();
+		outNormal = outNormal.GetSafeNormal();
+		return hits.Num();
+	}
+
+	FORCEINLINE FQuat ComputeClimbRotation(const FQuat& currentQuat, const FVector& surfaceNormal, float deltaTime) {
+		auto targetQuat = FRotationMatrix::MakeFromX(-surfaceNormal).ToQuat();
+		return FMath::QInterpTo(currentQuat, targetQuat, deltaTime, ClimbRotationInterpSpeed);
+	}
+
+	FORCEINLINE FVector ComputeSnapDelta(const FVector& location, const FVector& forward, const FVector& surfaceLocation, const FVector& surfaceNormal, float deltaTime, float snapSpeed) {
+		auto projectedCharToSurface = (surfaceLocation - location).ProjectOnTo(forward);
+		auto snapVector = -surfaceNormal * projectedCharToSurface.Length();
+		return snapVector * deltaTime * snapSpeed;
+	}
+
+	/** Climb input is expressed along the wall, up is Y and right is X, the same way AClimbingSystemCharacter maps it */
+	FORCEINLINE FVector ComputeClimbInputDirection(const FVector2D& input, const FVector& surfaceNormal, const FVector& right, const FVector& up) {
+		auto forwardDirection = FVector::CrossProduct(-surfaceNormal, right);
+		auto rightDirection = FVector::CrossProduct(-surfaceNormal, -up);
+		return forwardDirection * input.Y + rightDirection * input.X;
+	}
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace ClimbMath {
+	/**
+	 * Structure-of-arrays lanes for the per-climber surface math in ClimbMath, so a whole Mass chunk runs four
+	 * climbers per vector op. Lanes are padded to a multiple of four with zeros, which keeps the kernels free of a
+	 * scalar tail and makes unused lanes produce a zero snap and no stop.
+	 * Positions are stored relative to the climber, so single precision stays exact enough at large world coordinates.
+	 */
+	struct CLIMBINGSYSTEM_API FClimbSurfaceBatch {
+		static constexpr int32 LaneWidth = 4;
+		using FLaneArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+		void Reset(int32 numClimbers);
+
+		/** Fills one lane from the same inputs ClimbMath::ComputeSnapDelta and ClimbMath::ShouldStopClimbing take */
+		FORCEINLINE void SetClimber(int32 index, const FVector& location, const FVector& forward, const FVector& surfaceLocation, const FVector& surfaceNormal) {
+			const auto toSurface = surfaceLocation - location;
+			ToSurfaceX[index] = toSurface.X;
+			ToSurfaceY[index] = toSurface.Y;
+			ToSurfaceZ[index] = toSurface.Z;
+			ForwardX[index] = forward.X;
+			ForwardY[index] = forward.Y;
+			ForwardZ[index] = forward.Z;
+			NormalX[index] = surfaceNormal.X;
+			NormalY[index] = surfaceNormal.Y;
+			NormalZ[index] = surfaceNormal.Z;
+		}
+
+		FORCEINLINE void SetNormal(int32 index, const FVector& surfaceNormal) {
+			NormalX[index] = surfaceNormal.X;
+			NormalY[index] = surfaceNormal.Y;
+			NormalZ[index] = surfaceNormal.Z;
+		}
+
+		/** Batched ClimbMath::ShouldStopClimbing over every lane's normal */
+		void ComputeShouldStop();
+		/** Batched ClimbMath::ComputeSnapDelta, all lanes share the step and snap speed the way a Mass chunk shares its params */
+		void ComputeSnapDeltas(float deltaTime, float snapSpeed);
+
+		FORCEINLINE bool ShouldStop(int32 index) const {
+			return (StopMasks[index / LaneWidth] >> (index % LaneWidth)) & 1;
+		}
+
+		FORCEINLINE FVector GetSnapDelta(int32 index) const {
+			return FVector(SnapX[index], SnapY[index], SnapZ[index]);
+		}
+
+		FORCEINLINE int32 Num() const { return numClimbers; }
+
+	private:
+		FLaneArray ToSurfaceX, ToSurfaceY, ToSurfaceZ;
+		FLaneArray ForwardX, ForwardY, ForwardZ;
+		FLaneArray NormalX, NormalY, NormalZ;
+		FLaneArray SnapX, SnapY, SnapZ;
+		TArray<uint8> StopMasks;
+		int32 numClimbers = 0;
+		int32 numLanes = 0;
+	};
+}
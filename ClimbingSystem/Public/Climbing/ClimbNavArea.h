@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavAreas/NavArea.h"
+#include "ClimbNavArea.generated.h"
+
+/** Area of the navmesh links AClimbNavGraph publishes, UClimbPathFollowingComponent climbs across links of this area */
+UCLASS(Config = Engine)
+class CLIMBINGSYSTEM_API UClimbNavArea : public UNavArea
+{
+	GENERATED_BODY()
+
+public:
+	UClimbNavArea();
+};
@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AI/Navigation/NavRelevantInterface.h"
+#include "AI/Navigation/NavLinkDefinition.h"
+#include "NavLinkHostInterface.h"
+#include "ClimbNavGraph.generated.h"
+
+class AClimbSurfaceIndex;
+class AClimbingSystemCharacter;
+
+UENUM(BlueprintType)
+enum class EClimbNavNodeType : uint8 {
+	/** Standing spot in front of a wall low enough to start climbing from */
+	WallEntry,
+	/** Hang point on the wall */
+	Wall,
+	/** Standing spot on top of a climbable edge */
+	Ledge,
+	VaultStart,
+	VaultLand
+};
+
+UENUM(BlueprintType)
+enum class EClimbNavAction : uint8 {
+	/** Get to the first node of the path however the caller normally moves */
+	Move,
+	Climb,
+	StartClimbing,
+	StopClimbing,
+	HopUp,
+	HopDown,
+	ClimbUp,
+	ClimbDown,
+	Vault
+};
+
+USTRUCT()
+struct FClimbNavNode {
+	GENERATED_BODY()
+
+	/** Where the character stands or hangs at this node */
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	/** Hang point on the wall the node attaches to, the same as Location for wall nodes */
+	UPROPERTY()
+	FVector Anchor = FVector::ZeroVector;
+
+	UPROPERTY()
+	FVector3f Normal = FVector3f::ZeroVector;
+
+	UPROPERTY()
+	EClimbNavNodeType Type = EClimbNavNodeType::Wall;
+};
+
+USTRUCT()
+struct FClimbNavEdge {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 To = INDEX_NONE;
+
+	/** Seconds to traverse */
+	UPROPERTY()
+	float Cost = 0.f;
+
+	UPROPERTY()
+	EClimbNavAction Action = EClimbNavAction::Climb;
+};
+
+/** One leg of a climb route, perform Action to end up at Location */
+USTRUCT(BlueprintType)
+struct FClimbNavStep {
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Climb Nav Graph")
+	EClimbNavAction Action = EClimbNavAction::Move;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Climb Nav Graph")
+	FVector Location = FVector::ZeroVector;
+
+	/** Wall normal to face, zero for standing nodes */
+	UPROPERTY(BlueprintReadOnly, Category = "Climb Nav Graph")
+	FVector Normal = FVector::ZeroVector;
+};
+
+/**
+ * Climb routes over the level's static geometry, baked in the editor from the AClimbSurfaceIndex and saved with the level.
+ * Edges are stored flat per node so the search only touches contiguous arrays. Ground routes the graph connects are
+ * published to the navmesh as UClimbNavArea links, UClimbPathFollowingComponent asks FindClimbPath for the actions
+ * across a link when its path reaches one and performs them.
+ */
+UCLASS(hidecategories = (Actor, Input, Rendering, Replication, Collision, HLOD, Physics, Networking))
+class CLIMBINGSYSTEM_API AClimbNavGraph : public AActor, public INavLinkHostInterface, public INavRelevantInterface
+{
+	GENERATED_BODY()
+
+public:
+	AClimbNavGraph();
+
+#if WITH_EDITOR
+	/** Rebuilds the graph from the first baked AClimbSurfaceIndex in the level */
+	UFUNCTION(CallInEditor, Category = "Climb Nav Graph")
+	void Bake();
+
+	void PostEditUndo() override;
+#endif
+
+	void PostLoad() override;
+
+	/** Cheapest action sequence between the nodes nearest start and goal, callable from any thread since each keeps its own search scratch */
+	UFUNCTION(BlueprintCallable, Category = "Climb Nav Graph")
+	bool FindClimbPath(const FVector& start, const FVector& goal, TArray<FClimbNavStep>& outSteps) const;
+
+	/** Closest node within MaxNodeSnapDistance, INDEX_NONE when there is none */
+	int32 FindNearestNode(const FVector& location) const;
+
+	FORCEINLINE bool IsBaked() const { return !Nodes.IsEmpty(); }
+	FORCEINLINE const TArray<FClimbNavNode>& GetNodes() const { return Nodes; }
+	FORCEINLINE TConstArrayView<FClimbNavEdge> GetEdges(int32 nodeIndex) const {
+		return TConstArrayView<FClimbNavEdge>(Edges.GetData() + EdgeOffsets[nodeIndex], EdgeOffsets[nodeIndex + 1] - EdgeOffsets[nodeIndex]);
+	}
+
+#pragma region NavLinks
+	bool GetNavigationLinksClasses(TArray<TSubclassOf<UNavLinkDefinition>>& OutClasses) const override;
+	bool GetNavigationLinksArray(TArray<FNavigationLink>& OutLink, TArray<FNavigationSegmentLink>& OutSegments) const override;
+	void GetNavigationData(FNavigationRelevantData& Data) const override;
+	FBox GetNavigationBounds() const override;
+	bool IsNavigationRelevant() const override;
+#pragma endregion
+
+private:
+	struct FSearchNode {
+		float Cost = 0.f;
+		int32 ParentEdge = INDEX_NONE;
+		int32 Parent = INDEX_NONE;
+		uint32 Generation = 0;
+		bool bClosed = false;
+	};
+	struct FSearchScratch;
+
+	/** Scratch of the calling thread, sized for the largest graph it has searched */
+	static FSearchScratch& GetThreadSearchScratch();
+
+	/** Runs A* from startNode, or Dijkstra when goalNode is INDEX_NONE, calling onSettled for every node closed under maxCost */
+	bool Search(FSearchScratch& scratch, int32 startNode, int32 goalNode, float maxCost, TFunctionRef<void(int32, float)> onSettled) const;
+	void BuildNodeGrid();
+
+#if WITH_EDITOR
+	/** ClimberClass's limits for one bake, with the cost fallbacks filled in for actions it has no montage for */
+	struct FBakeParams {
+		float WallHangOffset = 0.f;
+		float StandHeight = 0.f;
+		float ClimbSpeed = 0.f;
+		float HopUpReach = 0.f;
+		float HopDownReach = 0.f;
+		float VaultLandClearance = 0.f;
+		float StartClimbingCost = 0.f;
+		float HopUpCost = 0.f;
+		float HopDownCost = 0.f;
+		float ClimbUpCost = 0.f;
+		float ClimbDownCost = 0.f;
+		float VaultCost = 0.f;
+	};
+
+	bool ResolveBakeParams(FBakeParams& outParams) const;
+	void BakeNodes(const AClimbSurfaceIndex& surfaceIndex, const FBakeParams& params);
+	void BakeEdges(const FBakeParams& params);
+	void BakeNavLinks();
+#endif
+
+	/** Character whose capsule, climb movement and montages the graph is baked for */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph")
+	TSubclassOf<AClimbingSystemCharacter> ClimberClass;
+
+	/** Graph node spacing, nodes are merged down to one of each type per cell of this size */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph", meta = (ClampMin = "10.0"))
+	float NodeSpacing = 60.f;
+
+	/** How far off the graph FindClimbPath's start and goal may be and still snap to a node */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph", meta = (ClampMin = "0.0"))
+	float MaxNodeSnapDistance = 300.f;
+
+	/** Wall heights above the floor CanStartClimbing's eye trace reaches */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph", meta = (ClampMin = "0.0"))
+	float EntryMinHeight = 50.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph", meta = (ClampMin = "0.0"))
+	float EntryMaxHeight = 150.f;
+
+	/** Action edge costs for montages ClimberClass does not set, otherwise an edge costs its montage's length */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Costs", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float StartClimbingCost = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Costs", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float HopCost = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Costs", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float ClimbUpCost = 1.5f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Costs", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float ClimbDownCost = 1.5f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Costs", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float VaultCost = 1.2f;
+
+	/** Publish every ground-to-ground climb route as a navmesh link */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Navigation")
+	bool bEmitNavLinks = true;
+
+	/** Routes costlier than this are not worth a navmesh link */
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Navigation", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float MaxNavLinkCost = 20.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Nav Graph|Navigation", meta = (ClampMin = "1"))
+	int32 MaxNavLinksPerNode = 4;
+
+	UPROPERTY()
+	TArray<FClimbNavNode> Nodes;
+
+	/** Nodes.Num() + 1 entries, node i's edges are Edges[EdgeOffsets[i]] up to EdgeOffsets[i + 1] */
+	UPROPERTY()
+	TArray<int32> EdgeOffsets;
+
+	UPROPERTY()
+	TArray<FClimbNavEdge> Edges;
+
+	/** Fastest distance per second over any edge, keeps the A* heuristic admissible */
+	UPROPERTY()
+	float HeuristicSpeed = 100.f;
+
+	UPROPERTY()
+	TArray<FNavigationLink> NavLinks;
+
+	// rebuilt from Nodes on load and bake, not worth saving, and only read by queries
+	TMap<FIntVector, TArray<int32, TInlineAllocator<4>>> nodeGrid;
+};
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Climbing/ClimbNavGraph.h"
+#include "ClimbPathFollowingComponent.generated.h"
+
+class AClimbingSystemCharacter;
+class UCustomMovementComponent;
+
+/**
+ * Path following that climbs across UClimbNavArea links. When a path segment starts on one it asks the level's
+ * AClimbNavGraph for the climb route to the link's end, performs the route's steps through the character's climb
+ * requests and then carries on along the navmesh path. AClimbAIController installs it.
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbPathFollowingComponent : public UPathFollowingComponent
+{
+	GENERATED_BODY()
+
+public:
+	FORCEINLINE bool IsFollowingClimbRoute() const { return climbStepIndex != INDEX_NONE; }
+	FORCEINLINE TConstArrayView<FClimbNavStep> GetClimbRoute() const { return climbSteps; }
+
+protected:
+	void SetMoveSegment(int32 SegmentStartIndex) override;
+	void UpdatePathSegment() override;
+	void FollowPathSegment(float DeltaTime) override;
+	void OnPathFinished(const FPathFollowingResult& Result) override;
+
+private:
+	bool IsClimbLinkSegment(int32 SegmentStartIndex) const;
+	void StartClimbRoute(const FVector& linkStart, const FVector& linkEnd);
+	void ResetClimbRoute();
+	/** Steers the character through the current step, true once the step is done */
+	bool UpdateClimbStep(AClimbingSystemCharacter& character, UCustomMovementComponent& movement, const FClimbNavStep& step);
+	void FinishClimbRoute();
+	AClimbNavGraph* GetClimbNavGraph();
+
+	/** Move and climb steps count as reached within this distance */
+	UPROPERTY(EditAnywhere, Category = "Climbing", meta = (ClampMin = "1.0"))
+	float ClimbStepAcceptanceRadius = 30.f;
+
+	/** A step taking longer than this blocks the move */
+	UPROPERTY(EditAnywhere, Category = "Climbing", meta = (ClampMin = "0.0", Units = "Seconds"))
+	float ClimbStepTimeout = 5.f;
+
+	TArray<FClimbNavStep> climbSteps;
+	int32 climbStepIndex = INDEX_NONE;
+	float climbStepTime = 0.f;
+	bool bClimbStepRequested = false;
+	bool bClimbActionStarted = false;
+	TWeakObjectPtr<AClimbNavGraph> climbNavGraph;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#ifndef CLIMB_PERF_COUNTERS
+	#define CLIMB_PERF_COUNTERS !UE_BUILD_SHIPPING
+#endif
+
+/** Running totals of a climber's query and simulation cost, read and reset by the climb benchmark */
+struct FClimbPerfCounters {
+	uint32 NumSceneQueries = 0;
+	uint32 NumIndexQueries = 0;
+	uint32 NumHits = 0;
+	uint32 NumPhysClimbTicks = 0;
+	uint64 PhysClimbCycles = 0;
+	uint32 NumServerMoveBits = 0;
+	uint32 NumClientCorrections = 0;
+
+	void Reset() { *this = FClimbPerfCounters(); }
+
+	FClimbPerfCounters& operator+=(const FClimbPerfCounters& other) {
+		NumSceneQueries += other.NumSceneQueries;
+		NumIndexQueries += other.NumIndexQueries;
+		NumHits += other.NumHits;
+		NumPhysClimbTicks += other.NumPhysClimbTicks;
+		PhysClimbCycles += other.PhysClimbCycles;
+		NumServerMoveBits += other.NumServerMoveBits;
+		NumClientCorrections += other.NumClientCorrections;
+		return *this;
+	}
+};
+
+#if CLIMB_PERF_COUNTERS
+	#define CLIMB_PERF_COUNT(Counters, Member, Amount) (Counters).Member += (Amount)
+#else
+	#define CLIMB_PERF_COUNT(Counters, Member, Amount)
+#endif
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbQuerySubsystem.generated.h"
+
+class UClimbQuerySubsystem;
+class UCustomMovementComponent;
+
+/** Pre-physics tick the climbers' movement ticks depend on, so batch results are ready before PhysClimb */
+USTRUCT()
+struct FClimbQueryBatchTickFunction : public FTickFunction {
+	GENERATED_USTRUCT_BODY()
+
+	UClimbQuerySubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FClimbQueryBatchTickFunction> : public TStructOpsTypeTraitsBase2<FClimbQueryBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Collects every registered climber's surface, floor and ledge queries once per frame, folds queries
+ * that quantize to the same segment into one, and runs the unique set across worker threads.
+ * Climbers read their results back by index in PhysClimb.
+ *
+ * Only exact duplicates are folded, e.g. climbers stacked on one spot or replaying the same pose. Queries that merely
+ * overlap are kept apart: a sweep from another start hits the wall at other points with other normals, and handing
+ * those to a climber would move it differently than its own query. Climbers a metre apart therefore share nothing,
+ * the batch pays off through running every query in parallel instead.
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void RegisterClimber(UCustomMovementComponent* climber);
+	void UnregisterClimber(UCustomMovementComponent* climber);
+
+	/** Returns the query index to read the hits back with, identical requests share one */
+	int32 AddSweep(const FVector& start, const FVector& end, const FCollisionShape& shape, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams);
+	int32 AddLineTrace(const FVector& start, const FVector& end, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams);
+
+	FORCEINLINE const TArray<FHitResult>& GetHits(int32 queryIndex) const { return queries[queryIndex].Hits; }
+	/** Bumped every batch, climbers compare against it to know their indices are from this frame */
+	FORCEINLINE uint32 GetBatchNumber() const { return batchNumber; }
+	FORCEINLINE FClimbQueryBatchTickFunction& GetBatchTickFunction() { return batchTickFunction; }
+	/** Queries climbers asked for in the last batch, and how many of them were left to run after folding duplicates */
+	FORCEINLINE int32 GetNumRequests() const { return numRequests; }
+	FORCEINLINE int32 GetNumUniqueQueries() const { return numQueries; }
+	/** Runs batches on the calling thread, the serial baseline the benchmark compares the parallel batch against */
+	FORCEINLINE void SetForceSingleThread(bool bInForceSingleThread) { bForceSingleThread = bInForceSingleThread; }
+
+	void RunBatch();
+
+private:
+	struct FQueryKey {
+		FIntVector Start;
+		FIntVector End;
+		FVector3f Extent;
+		int32 ObjectTypes;
+		uint8 MobilityType;
+		uint8 bSweep;
+
+		bool operator==(const FQueryKey& other) const {
+			return Start == other.Start && End == other.End && Extent == other.Extent &&
+				ObjectTypes == other.ObjectTypes && MobilityType == other.MobilityType && bSweep == other.bSweep;
+		}
+
+		friend uint32 GetTypeHash(const FQueryKey& key) {
+			auto hash = HashCombine(GetTypeHash(key.Start), GetTypeHash(key.End));
+			hash = HashCombine(hash, GetTypeHash(key.Extent));
+			return HashCombine(hash, GetTypeHash(key.ObjectTypes) ^ (key.MobilityType << 1 | key.bSweep));
+		}
+	};
+
+	struct FQuery {
+		FVector Start;
+		FVector End;
+		FCollisionShape Shape;
+		const FCollisionObjectQueryParams* ObjectParams;
+		const FCollisionQueryParams* QueryParams;
+		bool bSweep;
+		TArray<FHitResult> Hits;
+	};
+
+	int32 AddQuery(const FVector& start, const FVector& end, const FCollisionShape& shape, bool bSweep, const FCollisionObjectQueryParams& objectParams, const FCollisionQueryParams& queryParams);
+
+	FClimbQueryBatchTickFunction batchTickFunction;
+	TArray<TWeakObjectPtr<UCustomMovementComponent>> climbers;
+	// queries keep their hit arrays between frames, the batch only resets the count in use
+	TArray<FQuery> queries;
+	int32 numQueries = 0;
+	int32 numRequests = 0;
+	TMap<FQueryKey, int32> queryLookup;
+	uint32 batchNumber = 0;
+	bool bForceSingleThread = false;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ClimbRootMotionCache.generated.h"
+
+class UAnimMontage;
+
+/** Time range of a montage's motion warping notify, the root has to reach WarpTargetName by EndTime */
+USTRUCT()
+struct FClimbWarpWindow {
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	FName WarpTargetName;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	float StartTime = 0.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	float EndTime = 0.f;
+};
+
+/** Root translation of one montage sampled at a fixed rate, in mesh space relative to the first frame */
+USTRUCT()
+struct FClimbBakedRootMotion {
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	float Duration = 0.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	float SampleInterval = 0.f;
+
+	UPROPERTY()
+	TArray<FVector3f> Translations;
+
+	/** Sorted by EndTime */
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	TArray<FClimbWarpWindow> WarpWindows;
+
+	FVector Evaluate(float time) const;
+	FORCEINLINE bool IsValid() const { return Duration > 0.f && SampleInterval > 0.f && !Translations.IsEmpty(); }
+};
+
+/**
+ * Root motion of the climb montages baked offline, so servers can move climbers through climb
+ * entries, hops and vaults without a skeletal mesh or an anim instance.
+ * Curves are keyed by montage asset name.
+ */
+UCLASS(BlueprintType)
+class CLIMBINGSYSTEM_API UClimbRootMotionCache : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+#if WITH_EDITOR
+	/** Samples every montage in SourceMontages, replacing previously baked curves */
+	UFUNCTION(CallInEditor, Category = "Climb Root Motion")
+	void Bake();
+#endif
+
+	const FClimbBakedRootMotion* Find(const UAnimMontage* montage) const;
+	FORCEINLINE const FClimbBakedRootMotion* Find(FName curveName) const { return Curves.Find(curveName); }
+
+private:
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(EditAnywhere, Category = "Climb Root Motion")
+	TArray<TSoftObjectPtr<UAnimMontage>> SourceMontages;
+#endif
+
+	UPROPERTY(EditAnywhere, Category = "Climb Root Motion", meta = (ClampMin = "10.0", Units = "Hz"))
+	float BakeSampleRate = 60.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Root Motion")
+	TMap<FName, FClimbBakedRootMotion> Curves;
+};
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/RootMotionSource.h"
+#include "ClimbRootMotionSource.generated.h"
+
+class UClimbRootMotionCache;
+struct FClimbBakedRootMotion;
+
+/**
+ * Plays a baked climb curve as an override root motion source, the anim-less stand in for a climb montage.
+ * Motion warping is approximated by spreading each warp window's error over the window.
+ */
+USTRUCT()
+struct CLIMBINGSYSTEM_API FRootMotionSource_ClimbCurve : public FRootMotionSource {
+	GENERATED_USTRUCT_BODY()
+
+	FRootMotionSource_ClimbCurve();
+	virtual ~FRootMotionSource_ClimbCurve() {}
+
+	UPROPERTY()
+	TObjectPtr<UClimbRootMotionCache> Cache = nullptr;
+
+	UPROPERTY()
+	FName CurveName;
+
+	UPROPERTY()
+	FVector StartLocation = FVector::ZeroVector;
+
+	/** Actor rotation at the start combined with the mesh's base rotation, turns mesh space curves into world space */
+	UPROPERTY()
+	FQuat CurveToWorld = FQuat::Identity;
+
+	/** World space correction each warp window has to add by its end, in the curve's window order */
+	UPROPERTY()
+	TArray<FVector> WarpOffsets;
+
+	/** Resolves warp offsets from warpTargets, which hold where the root should be at the end of each named window */
+	void InitWarpOffsets(const FClimbBakedRootMotion& curve, const TMap<FName, FVector>& warpTargets, const FVector& rootToActorOffset);
+
+	virtual FRootMotionSource* Clone() const override;
+	virtual bool Matches(const FRootMotionSource* Other) const override;
+	virtual bool MatchesAndHasSameState(const FRootMotionSource* Other) const override;
+	virtual bool UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup = false) override;
+	virtual void PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent) override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override;
+	virtual FString ToSimpleString() const override;
+	virtual void AddReferencedObjects(class FReferenceCollector& Collector) override;
+
+private:
+	FVector EvaluateWorldLocation(const FClimbBakedRootMotion& curve, float time) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRootMotionSource_ClimbCurve> : public TStructOpsTypeTraitsBase2<FRootMotionSource_ClimbCurve>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
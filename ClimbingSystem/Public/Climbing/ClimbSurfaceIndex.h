@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ClimbSurfaceIndex.generated.h"
+
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EClimbSurfaceCellFlags : uint8 {
+	None = 0,
+	Climbable = 1 << 0,
+	Walkable = 1 << 1,
+	LedgeEdge = 1 << 2,
+	Vaultable = 1 << 3
+};
+ENUM_CLASS_FLAGS(EClimbSurfaceCellFlags)
+
+/** One face cluster of a cell, a cell crossed by several faces (a thin wall, an edge, a corner) keeps one entry per face */
+USTRUCT()
+struct FClimbSurfaceCell {
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint64 Key = 0;
+
+	UPROPERTY()
+	FVector3f Normal = FVector3f::ZeroVector;
+
+	/** Offset of the face's plane along Normal, fitted through the mean of the face's baked impact points */
+	UPROPERTY()
+	float PlaneDistance = 0.f;
+
+	UPROPERTY()
+	uint8 Flags = 0;
+
+	FORCEINLINE bool HasAnyFlags(EClimbSurfaceCellFlags inFlags) const { return (Flags & static_cast<uint8>(inFlags)) != 0; }
+	FORCEINLINE FVector ProjectOntoSurface(const FVector& location) const {
+		const auto normal = FVector(Normal);
+		return location - normal * (FVector::DotProduct(normal, location) - PlaneDistance);
+	}
+};
+
+/**
+ * Sparse voxel index of the level's static climbable geometry, baked in the editor and saved with the level.
+ * Cells are kept sorted by key so lookups are a binary search and the data serializes as a flat array; the faces
+ * sharing a cell sit next to each other under the same key.
+ */
+UCLASS(hidecategories = (Actor, Input, Rendering, Replication, Collision, HLOD, Physics, Networking))
+class CLIMBINGSYSTEM_API AClimbSurfaceIndex : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AClimbSurfaceIndex();
+
+#if WITH_EDITOR
+	/** Samples every static component matching SurfaceTraceTypes inside the bake bounds */
+	UFUNCTION(CallInEditor, Category = "Climb Surface Index")
+	void Bake();
+#endif
+
+	bool LineTrace(const FVector& start, const FVector& end, FHitResult& outHit) const;
+	bool SweepCapsule(const FVector& start, const FVector& end, float radius, float halfHeight, TArray<FHitResult>& outHits) const;
+	bool HasCellWithFlagsInBox(const FBox& box, EClimbSurfaceCellFlags inFlags) const;
+	/** Every face baked into the cell, empty when the cell holds no geometry */
+	TArrayView<const FClimbSurfaceCell> FindCellFaces(const FIntVector& cellCoord) const;
+	bool CellHasAnyFlags(const FIntVector& cellCoord, EClimbSurfaceCellFlags inFlags) const;
+
+	FORCEINLINE FIntVector ToCellCoord(const FVector& location) const {
+		return FIntVector(
+			FMath::FloorToInt(location.X / CellSize),
+			FMath::FloorToInt(location.Y / CellSize),
+			FMath::FloorToInt(location.Z / CellSize));
+	}
+	FORCEINLINE FVector ToCellCenter(const FIntVector& cellCoord) const { return (FVector(cellCoord) + 0.5f) * CellSize; }
+
+	/** Older bakes averaged every face of a cell into one plane, so those levels fall back to live traces until rebaked */
+	FORCEINLINE bool IsBaked() const { return !Cells.IsEmpty() && BakeVersion >= FaceClusterBakeVersion; }
+	FORCEINLINE float GetCellSize() const { return CellSize; }
+	FORCEINLINE const TArray<FClimbSurfaceCell>& GetCells() const { return Cells; }
+
+	static uint64 PackCellKey(const FIntVector& cellCoord);
+	static FIntVector UnpackCellKey(uint64 key);
+
+	static constexpr int32 FaceClusterBakeVersion = 2;
+
+private:
+	UPROPERTY(EditAnywhere, Category = "Climb Surface Index", meta = (ClampMin = "5.0"))
+	float CellSize = 20.f;
+
+	/** Leave invalid to bake around every matching static component in the level */
+	UPROPERTY(EditAnywhere, Category = "Climb Surface Index")
+	FBox BakeBounds = FBox(ForceInit);
+
+	UPROPERTY(EditAnywhere, Category = "Climb Surface Index")
+	TArray<TEnumAsByte<EObjectTypeQuery>> SurfaceTraceTypes;
+
+	/** Bakes that would cast more rays than this are refused, raise CellSize or shrink BakeBounds instead */
+	UPROPERTY(EditAnywhere, Category = "Climb Surface Index", meta = (ClampMin = "1"))
+	int32 MaxBakeRays = 4000000;
+
+	UPROPERTY(EditAnywhere, Category = "Climb Surface Index", meta = (ClampMin = "0.0"))
+	float VaultMaxObstacleHeight = 100.f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Climb Surface Index")
+	int32 BakeVersion = 0;
+
+	UPROPERTY()
+	TArray<FClimbSurfaceCell> Cells;
+
+	friend struct FClimbSurfaceIndexTestAccess;
+};
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_STATS_GROUP(TEXT("Climbing"), STATGROUP_Climbing, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysClimb"), STAT_Climb_PhysClimb, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TraceClimbableSurfaces"), STAT_Climb_TraceClimbableSurfaces, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CheckHasReachedFloor"), STAT_Climb_CheckHasReachedFloor, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LedgeDetected"), STAT_Climb_LedgeDetected, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CanStartVaulting"), STAT_Climb_CanStartVaulting, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CheckCanHopUp"), STAT_Climb_CheckCanHopUp, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CheckCanHopDown"), STAT_Climb_CheckCanHopDown, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("onClimbMontageEnded"), STAT_Climb_OnClimbMontageEnded, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mass Surface Query"), STAT_Climb_MassSurfaceQuery, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mass Movement"), STAT_Climb_MassMovement, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Query Batch"), STAT_Climb_QueryBatch, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Nav Graph Search"), STAT_Climb_NavGraphSearch, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateClimbLimbIK"), STAT_Climb_LimbIK, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Climbing Characters"), STAT_Climb_NumClimbers, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Scene Queries"), STAT_Climb_SceneQueries, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Index Queries"), STAT_Climb_IndexQueries, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Query Hits"), STAT_Climb_QueryHits, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Max Scene Queries By One Climber"), STAT_Climb_MaxClimberSceneQueries, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Query Requests"), STAT_Climb_BatchedQueryRequests, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Unique Queries"), STAT_Climb_BatchedUniqueQueries, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Candidate Resolves"), STAT_Climb_CandidateResolves, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Candidate Fallbacks"), STAT_Climb_CandidateFallbacks, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Montage Fallbacks"), STAT_Climb_MontageFallbacks, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Server Move Bits"), STAT_Climb_ServerMoveBits, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Client Corrections"), STAT_Climb_ClientCorrections, STATGROUP_Climbing, CLIMBINGSYSTEM_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CLIMBINGSYSTEM_API, Climbing);
+
+// one scope feeds stat climbing, the CSV profiler and Insights; nothing is left of it in Shipping
+#if !UE_BUILD_SHIPPING
+	#define CLIMB_SCOPE_CYCLE_COUNTER(StatId, ScopeName) \
+		SCOPE_CYCLE_COUNTER(StatId); \
+		CSV_SCOPED_TIMING_STAT(Climbing, ScopeName); \
+		TRACE_CPUPROFILER_EVENT_SCOPE(Climb_##ScopeName)
+#else
+	#define CLIMB_SCOPE_CYCLE_COUNTER(StatId, ScopeName)
+#endif
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Climbing/ClimbPerfCounters.h"
+#include "Debug/ClimbDebugDrawSubsystem.h"
 #include "CustomMovementComponent.generated.h"
 
 DECLARE_DELEGATE(FOnEnterClimbState)
@@ -12,6 +14,150 @@ DECLARE_DELEGATE(FOnExitClimbState)
 class UAnimMontage;
 class UAnimInstance;
 class AClimbingSystemCharacter;
+class AClimbSurfaceIndex;
+class FSavedMove_Climb;
+class UClimbRootMotionCache;
+class UClimbQuerySubsystem;
+struct FStreamableHandle;
+class USkeletalMeshComponentBudgeted;
+enum class EClimbSurfaceCellFlags : uint8;
+
+UENUM(BlueprintType)
+enum class EClimbLOD : uint8 {
+	Full,
+	Reduced,
+	Minimal
+};
+
+UENUM(BlueprintType)
+enum class EClimbLimb : uint8 {
+	LeftHand,
+	RightHand,
+	LeftFoot,
+	RightFoot,
+	Num UMETA(Hidden)
+};
+
+/** Where one hand or foot should touch the climb surface, in world space for a two bone IK effector */
+USTRUCT(BlueprintType)
+struct FClimbLimbIKTarget {
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FVector Normal = FVector::ZeroVector;
+
+	/** 0 leaves the limb to the animation, blends in and out rather than popping when a surface is found or lost */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	float Alpha = 0.f;
+};
+
+/** Movement state the anim instance needs, published once per movement tick so animation can update off the game thread */
+USTRUCT(BlueprintType)
+struct FClimbAnimSnapshot {
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FVector Velocity = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FVector UnrotatedClimbVelocity = FVector::ZeroVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	bool bHasAcceleration = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	bool bIsFalling = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	bool bIsClimbing = false;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FClimbLimbIKTarget LeftHandIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FClimbLimbIKTarget RightHandIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FClimbLimbIKTarget LeftFootIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Climbing")
+	FClimbLimbIKTarget RightFootIK;
+
+	FClimbLimbIKTarget& GetLimbIK(EClimbLimb limb) {
+		switch(limb) {
+			case EClimbLimb::LeftHand: return LeftHandIK;
+			case EClimbLimb::RightHand: return RightHandIK;
+			case EClimbLimb::LeftFoot: return LeftFootIK;
+			default: return RightFootIK;
+		}
+	}
+};
+
+/** Last surface a limb's IK trace found, kept relative to the hit component so it can be reprojected until the next trace */
+struct FClimbLimbIKState {
+	FTraceHandle TraceHandle;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FVector LocalPoint = FVector::ZeroVector;
+	FVector LocalNormal = FVector::ZeroVector;
+	bool bHasSurface = false;
+	float Alpha = 0.f;
+};
+
+/** Hits of one in-flight async trace, filled in place from the trace datum when the world runs the trace delegates */
+struct FClimbAsyncTraceSlot {
+	FTraceHandle Handle;
+	TArray<FHitResult> Hits;
+	uint64 IssuedFrame = 0;
+	bool bDone = false;
+};
+
+/** Last climbable surface sweep, reused while the character holds still on the wall */
+struct FClimbSurfaceCache {
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	TArray<TPair<TWeakObjectPtr<UPrimitiveComponent>, FTransform>, TInlineAllocator<8>> HitComponents;
+	int32 TicksSinceRefresh = 0;
+	bool bValid = false;
+};
+
+/** Outcome of the hop, climb entry and vault probes for one pose, so input can resolve without tracing */
+struct FClimbActionCandidates {
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	float EvaluationTime = -1.f;
+	// hop candidates are only evaluated on the wall, entry and vault candidates only off it
+	bool bClimbing = false;
+
+	bool bCanHopUp = false;
+	FVector HopUpTarget = FVector::ZeroVector;
+	bool bCanHopDown = false;
+	FVector HopDownTarget = FVector::ZeroVector;
+
+	bool bCanStartClimbing = false;
+	bool bCanClimbDown = false;
+	bool bCanVault = false;
+	FVector VaultStart = FVector::ZeroVector;
+	FVector VaultLand = FVector::ZeroVector;
+};
+
+/** The movement limits and action lengths AClimbNavGraph bakes its edges from, so the graph never disagrees with the component */
+struct FClimbNavTraversalParams {
+	float ClimbSpeed = 0.f;
+	float HopUpReach = 0.f;
+	float HopDownReach = 0.f;
+	float VaultLandClearance = 0.f;
+
+	// seconds, 0 when the montage is not set and the graph has to fall back to its own estimate
+	float StartClimbingDuration = 0.f;
+	float HopUpDuration = 0.f;
+	float HopDownDuration = 0.f;
+	float ClimbUpDuration = 0.f;
+	float ClimbDownDuration = 0.f;
+	float VaultDuration = 0.f;
+};
 
 UENUM(BlueprintType)
 namespace ECustomMovementMode {
@@ -28,39 +174,65 @@ class CLIMBINGSYSTEM_API UCustomMovementComponent : public UCharacterMovementCom
 	GENERATED_BODY()
 
 public:
+	UCustomMovementComponent();
+
 	FOnEnterClimbState OnEnterClimbStateDelegate;
 	FOnExitClimbState OnExitClimbStateDelegate;
+
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	/** Called by UClimbQuerySubsystem in pre-physics to queue this tick's surface, floor and ledge queries */
+	void GatherBatchedClimbQueries(UClimbQuerySubsystem& querySubsystem);
 	
 protected:
 #pragma region OverridenFunctions
 	void BeginPlay() override;
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
 	void PhysCustom(float deltaTime, int32 Iterations) override;
 	float GetMaxSpeed() const override;
 	float GetMaxAcceleration() const override;
 	FVector ConstrainAnimRootMotionVelocity(const FVector& RootMotionVelocity, const FVector& CurrentVelocity) const override;
+	void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	void UpdateCharacterStateAfterMovement(float DeltaSeconds) override;
+	void UpdateFromCompressedFlags(uint8 Flags) override;
+	bool ClientUpdatePositionAfterServerUpdate() override;
+	void ServerMovePacked_ClientSend(const FCharacterServerMovePackedBits& PackedBits) override;
+	void ClientHandleMoveResponse(const FCharacterMoveResponseDataContainer& MoveResponse) override;
 #pragma endregion
 
 private:
 #pragma region ClimbTraces
-TArray<FHitResult> DoCapsuleTraceMultiByObject(const FVector& start, const FVector& end, bool bShowDebugShape = false, bool bDrawPersistentShapes = false);
-FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, bool bShowDebugShape = false, bool bDrawPersistentShapes = false, FColor color = FColor::Red);
+void InitClimbQueryParams();
+void FindSurfaceIndex();
+bool ShouldUseAsyncClimbQueries() const;
+bool ShouldUseBatchedClimbQueries() const;
+bool DoCapsuleTraceMultiByObject(const FVector& start, const FVector& end, TArray<FHitResult>& outHits, EClimbDebugCategory debugCategory, bool bShowDebugShape = false, bool bDrawPersistentShapes = false);
+FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, EClimbDebugCategory debugCategory, bool bShowDebugShape = false, bool bDrawPersistentShapes = false, FColor color = FColor::Red);
 #pragma endregion
 
 #pragma region ClimbCore
 	
 	bool TraceClimbableSurfaces();
-	FHitResult TraceFromEyeHeight(float TraceDistance, float TraceStartOffset = 0.f, bool bShowDebugShape = false, bool bDrawPersistentShapes = false);
+	FHitResult TraceFromEyeHeight(float TraceDistance, float TraceStartOffset = 0.f, EClimbDebugCategory debugCategory = EClimbDebugCategory::EyeHeight, bool bShowDebugShape = false, bool bDrawPersistentShapes = false);
+	void GetClimbableSurfaceTraceSegment(FVector& outStart, FVector& outEnd) const;
+	void GetEyeHeightTraceSegment(float TraceDistance, float TraceStartOffset, FVector& outStart, FVector& outEnd) const;
+	void GetFloorTraceSegment(FVector& outStart, FVector& outEnd) const;
 	bool CanStartClimbing();
+	void TryStartClimbing();
 
 	void startClimbing();
 	void stopClimbing();
 	void PhysClimb(float deltaTime, int32 Iterations);
+	float GetClimbSimulationTimeStep(float remainingTime, int32 Iterations) const;
 	void processClimbableSurfaceInfo();
+	void blendClimbableSurfaceInfo(float deltaTime);
 
 	bool CheckShouldStopClimbing();
 	bool CheckHasReachedFloor();
+	bool EvaluateFloorHits(const TArray<FHitResult>& floorHits) const;
 
 	bool LedgeDetected();
 	bool CanClimbDown();
@@ -71,12 +243,15 @@ FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, b
 	FQuat GetClimbRotation(float deltaTime);
 	void snapMovementToSurface(float deltaTime);
 
-	void playClimbMontage(UAnimMontage* montageToPlay);
+	void playClimbMontage(const TSoftObjectPtr<UAnimMontage>& montageToPlay);
+	void PublishAnimSnapshot();
 
 	UFUNCTION()
 	void onClimbMontageEnded(UAnimMontage* montage, bool interrupted);
+	void onClimbActionFinished(const TSoftObjectPtr<UAnimMontage>& montage);
 	void SetMotionWarpTarget(const FName& inWarpTargetName, const FVector& inTargetPos);
 
+	void HandleHopping();
 	void HandleHopUp();
 	void HandleHopDown();
 	bool CheckCanHopUp(FVector& inTargetPos);
@@ -84,10 +259,105 @@ FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, b
 
 #pragma endregion
 
+#pragma region ClimbBakedRootMotion
+	bool ShouldUseBakedRootMotion() const;
+	bool NeedsClimbMontages() const;
+	bool PlayBakedRootMotion(const TSoftObjectPtr<UAnimMontage>& montage);
+	void PlayCosmeticClimbMontage(const TSoftObjectPtr<UAnimMontage>& montage);
+	void CheckBakedRootMotionFinished();
+#pragma endregion
+
+#pragma region ClimbNetworking
+	void ProcessClimbRequests();
+
+	UFUNCTION()
+	void OnRep_ClimbSurfaceNormal();
+#pragma endregion
+
+#pragma region ClimbLOD
+	void UpdateClimbLOD();
+	void UpdateClimbViewerDistance();
+	void SetClimbLOD(EClimbLOD newLOD);
+	int32 GetClimbLODSurfaceInterval() const;
+	int32 GetClimbLODProbeInterval() const;
+	bool IsClimbLODRefreshTick(int32 interval, uint32 ticksAhead = 0) const;
+#pragma endregion
+
+#pragma region ClimbSurfaceCache
+	bool CanReuseSurfaceCache() const;
+	void StoreSurfaceCache(const FVector& location, const FQuat& rotation);
+	void InvalidateSurfaceCache();
+#pragma endregion
+
+#pragma region ClimbAsyncQueries
+	void RequestAsyncClimbQueries();
+	bool ConsumeAsyncClimbQueries();
+	void ResetAsyncClimbQueries();
+	FTraceHandle RequestAsyncCapsuleTrace(const FVector& start, const FVector& end);
+	FTraceHandle RequestAsyncLineTrace(const FVector& start, const FVector& end);
+	bool ConsumeAsyncTrace(FTraceHandle& handle, TArray<FHitResult>& outHits);
+	FTraceHandle ClaimAsyncTraceSlot(const FTraceHandle& handle);
+	void OnAsyncTraceDone(const FTraceHandle& handle, FTraceDatum& traceData);
+#pragma endregion
+
+#pragma region ClimbCapsuleMorph
+	void BeginCapsuleMorph(float targetHalfHeight, bool bLevelOut);
+	void TickCapsuleMorph(float deltaTime);
+	bool FindUnencroachedCapsuleLocation(float halfHeight, FVector& inOutLocation) const;
+#pragma endregion
+
+#pragma region ClimbCandidates
+	bool ShouldRequestClimbCandidates();
+	void RequestClimbCandidates();
+	/** Fills candidates from the synchronous checks, for the pose they were requested at */
+	void EvaluateClimbCandidates(FClimbActionCandidates& candidates);
+	void ConsumeClimbCandidates();
+	void InvalidateClimbCandidates();
+	const FClimbActionCandidates* GetFreshClimbCandidates() const;
+	bool ConsumeCandidateTrace(int32 index, FHitResult& outHit);
+#pragma endregion
+
+#pragma region ClimbMontageStreaming
+	void UpdateClimbMontageStreaming();
+	/** indexFlags picks the baked cells that count, without the index any climbable object type in range does */
+	bool IsNearClimbableGeometry(float radius, EClimbSurfaceCellFlags indexFlags);
+	void RequestClimbMontages();
+	void ReleaseClimbMontages();
+#pragma endregion
+
+#pragma region ClimbAnimationBudget
+	void UpdateClimbAnimationBudget(bool bForce = false);
+	void OnAnimationReduceWork(USkeletalMeshComponentBudgeted* component, bool bReduce);
+#pragma endregion
+
+#pragma region ClimbLimbIK
+	void GetLimbIKTraceSegment(EClimbLimb limb, FVector& outStart, FVector& outEnd) const;
+	void RequestClimbLimbIK();
+	void ConsumeClimbLimbIK();
+	void UpdateClimbLimbIK(float deltaTime);
+	void ResetClimbLimbIK();
+#pragma endregion
+
+#pragma region ClimbBatchedQueries
+	bool ConsumeBatchedClimbQueries();
+	void CopyBatchedHits(int32 queryIndex, TArray<FHitResult>& outHits);
+#pragma endregion
+
 #pragma region ClimbCoreVariables
+	// query params and hit buffers are built once at BeginPlay and reused so the climb tick does not allocate
+	FCollisionQueryParams climbQueryParams;
+	FCollisionQueryParams climbDynamicQueryParams;
+	FCollisionObjectQueryParams climbObjectQueryParams;
 	TArray<FHitResult> climableSurfacesTracedResults;
+	TArray<FHitResult> floorTracedResults;
+	TArray<FHitResult> dynamicTracedResults;
+
+	UPROPERTY()
+	TWeakObjectPtr<AClimbSurfaceIndex> surfaceIndex;
 	FVector currentClimbableSurfaceLocation;
 	FVector currentClimbableSurfaceNormal;
+	FVector targetClimbableSurfaceLocation;
+	FVector targetClimbableSurfaceNormal;
 	
 	UPROPERTY()
 	UAnimInstance* owningPlayerAnimInstance;
@@ -95,6 +365,96 @@ FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, b
 	UPROPERTY()
 	AClimbingSystemCharacter* playerChar;
 
+	FClimbAnimSnapshot animSnapshot;
+	FClimbPerfCounters perfCounters;
+
+	// the baked stand in for the montage currently playing, 0 when none
+	uint16 bakedRootMotionSourceID = 0;
+	TSoftObjectPtr<UAnimMontage> bakedRootMotionMontage;
+	// while the curves move the climber its montages only pose the mesh, their root motion and end events are ignored
+	bool bClimbMontagesCosmetic = false;
+	TEnumAsByte<ERootMotionMode::Type> defaultRootMotionMode = ERootMotionMode::RootMotionFromMontagesOnly;
+	TMap<FName, FVector> motionWarpTargets;
+
+	// one-shot requests from input, carried to the server in the saved move flags and handled before the next move
+	bool bWantsToClimb = false;
+	bool bWantsToStopClimbing = false;
+	bool bWantsToHop = false;
+	bool bWantsToVault = false;
+	friend class FSavedMove_Climb;
+
+	/** simulated proxies never trace, they only need the normal to orient climb input and animation */
+	UPROPERTY(ReplicatedUsing = OnRep_ClimbSurfaceNormal)
+	FVector_NetQuantizeNormal replicatedClimbSurfaceNormal;
+
+	EClimbLOD currentClimbLOD = EClimbLOD::Full;
+	uint32 climbLODTickCounter = 0;
+	float lastClimbLODEvaluationTime = -1.f;
+	float climbViewerDistance = 0.f;
+	bool bClimbLODBlending = false;
+
+	FClimbSurfaceCache surfaceCache;
+	uint32 surfaceCacheHits = 0;
+	uint32 surfaceCacheMisses = 0;
+
+	FTraceHandle asyncSurfaceTraceHandle;
+	FVector asyncSurfaceRequestLocation;
+	FQuat asyncSurfaceRequestRotation;
+	FTraceHandle asyncFloorTraceHandle;
+	FTraceHandle asyncLedgeEyeTraceHandle;
+	FTraceHandle asyncLedgeDownTraceHandle;
+	TArray<FHitResult> asyncFloorHits;
+	TArray<FHitResult> asyncLedgeHits;
+	// QueryTraceData copies the datum's hit array, the delegate hands it over in place
+	FTraceDelegate asyncTraceDelegate;
+	TArray<FClimbAsyncTraceSlot> asyncTraceSlots;
+	bool bAsyncLedgeDetected = false;
+
+	// capsule height, and on exit pitch and roll, ease over CapsuleMorphDuration instead of snapping in OnMovementModeChanged
+	float standCapsuleHalfHeight = 96.f;
+	float capsuleMorphStartHalfHeight = 96.f;
+	float capsuleMorphTargetHalfHeight = 96.f;
+	FRotator capsuleMorphStartRotation = FRotator::ZeroRotator;
+	float capsuleMorphAlpha = 1.f;
+	bool bCapsuleMorphing = false;
+	bool bCapsuleMorphLevelsOut = false;
+
+	FClimbActionCandidates climbCandidates;
+	// one handle per probe, laid out by RequestClimbCandidates for the pose it was issued from
+	TArray<FTraceHandle, TInlineAllocator<16>> candidateTraceHandles;
+	FClimbActionCandidates pendingCandidates;
+	float lastCandidateRequestTime = -1.f;
+	TArray<FHitResult> candidateHits;
+
+	UPROPERTY()
+	TWeakObjectPtr<UClimbQuerySubsystem> querySubsystem;
+	// batch number the indices below were issued in, 0 once consumed
+	uint32 batchedQueryBatch = 0;
+	int32 batchedSurfaceQuery = INDEX_NONE;
+	FVector batchedSurfaceRequestLocation;
+	FQuat batchedSurfaceRequestRotation;
+	int32 batchedFloorQuery = INDEX_NONE;
+	int32 batchedLedgeEyeQuery = INDEX_NONE;
+	int32 batchedLedgeDownQuery = INDEX_NONE;
+
+	// keeps the climb montages resident while the character is near something to climb
+	TSharedPtr<FStreamableHandle> climbMontageHandle;
+	float lastMontageStreamingCheckTime = -1.f;
+	float lastNearClimbableTime = -1.f;
+
+	FClimbLimbIKState limbIKStates[static_cast<int32>(EClimbLimb::Num)];
+	float lastLimbIKRequestTime = -1.f;
+	// limbs are traced round robin when ClimbLimbIKMaxTracesPerTick is below the limb count
+	int32 nextLimbIKTrace = 0;
+	TArray<FHitResult> limbIKHits;
+
+	UPROPERTY()
+	TWeakObjectPtr<USkeletalMeshComponentBudgeted> budgetedMesh;
+	float lastAnimationBudgetUpdateTime = -1.f;
+	bool bAnimationBudgetProtected = false;
+	// set by the budget allocator when it is over budget, optional animation work like limb IK stops
+	bool bAnimationWorkReduced = false;
+
 #pragma endregion
 
 #pragma region ClimbVariables
@@ -113,38 +473,301 @@ FHitResult DoLineTraceSingleByObject(const FVector& start, const FVector& end, b
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float MaxClimbSpeed = 100.f;
 
+	/** Height above the eyes CheckCanHopUp looks for the wall to continue, the farthest a hop can go up */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float ClimbHopUpReach = 150.f;
+
+	/** Depth below the eyes CheckCanHopDown looks for the wall, the farthest a hop can go down */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float ClimbHopDownReach = 300.f;
+
+	/** Capsule half height while on the wall, the standing height is taken from the capsule at BeginPlay */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float ClimbCapsuleHalfHeight = 48.f;
+
+	/** Time the capsule takes to change height on climb enter and exit, 0 snaps it like a crouch */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", Units = "Seconds"))
+	float CapsuleMorphDuration = 0.15f;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float MaxClimbAcceleration = 300.f;
 
+	/** Longest step PhysClimb integrates at once, longer frames are split into sub-steps */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0166", ClampMax = "0.50", UIMin = "0.0166", UIMax = "0.50"))
+	float MaxClimbSimulationTimeStep = 0.05f;
+
+	/** Sub-step cap per frame, the last sub-step takes whatever time is left */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "1", ClampMax = "25", UIMin = "1", UIMax = "25"))
+	int32 MaxClimbSimulationIterations = 8;
+
+	/** Sub-steps keep using the frame's surface query until the climber has moved this far from where it was taken */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float ClimbSubStepRequeryDistance = 10.f;
+
+	/** Consecutive climb moves are only combined into one server move while the surface normal turns less than this */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Networking", meta = (AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "90.0", Units = "Degrees"))
+	float ClimbMoveCombineMaxNormalAngle = 2.f;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float ClimbDownWalkableSurfaceForwardTraceOffset = 100.f;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float ClimbDownLedgeForwardTraceOffset = 50.f;
 
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true"))
+	float VaultProbeHeight = 100.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true"))
+	float VaultStartForwardOffset = 150.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true"))
+	float VaultStartTraceDepth = 100.f;
+
+	/** Landing probe distance when VaultProfileSamples is 0 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true"))
+	float VaultLandForwardOffset = 650.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true"))
+	float VaultLandTraceDepth = 500.f;
+
+	/** Samples taken along the obstacle top to find its far edge, 0 keeps the two-trace fixed-distance vault */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 VaultProfileSamples = 0;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true", ClampMin = "1.0"))
+	float VaultProfileSpacing = 50.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float VaultProfileHeightTolerance = 20.f;
+
+	/** Distance past the obstacle's far edge to look for the landing spot */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Vault", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float VaultLandClearance = 100.f;
+
+	/** Answer static climb queries from the level's baked AClimbSurfaceIndex, live traces then only look at movable geometry */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bUseBakedSurfaceIndex = true;
+
+	/** Batch next tick's surface, floor and ledge queries through the async trace API and consume them one frame late */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bUseAsyncClimbQueries = false;
+
+	/** Queue surface, floor and ledge queries with the world's UClimbQuerySubsystem, which dedups and runs every climber's in parallel before physics */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bUseClimbQuerySubsystem = false;
+
+	/** Keep hop, climb entry, climb down and vault outcomes up to date in the background so input resolves without tracing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true"))
+	bool bUseClimbActionCandidates = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true", EditCondition = "bUseClimbActionCandidates", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbCandidateRefreshInterval = 0.1f;
+
+	/** Candidates are only gathered off the wall with climbable or vaultable geometry this close, it has to reach the wall or obstacle the probes start on */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true", EditCondition = "bUseClimbActionCandidates", ClampMin = "0.0"))
+	float ClimbCandidateProximityRadius = 250.f;
+
+	/** Candidates older than this are ignored and the action traces on the spot, anything past one refresh is a pose the server may no longer agree with */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true", EditCondition = "bUseClimbActionCandidates", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbCandidateMaxAge = 0.1f;
+
+	/** Candidates from further away than this, or turned by more than ClimbCandidateMaxTurn, are ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true", EditCondition = "bUseClimbActionCandidates", ClampMin = "0.0"))
+	float ClimbCandidateMaxDrift = 10.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|Candidates", meta = (AllowPrivateAccess = "true", EditCondition = "bUseClimbActionCandidates", ClampMin = "0.0", Units = "Degrees"))
+	float ClimbCandidateMaxTurn = 5.f;
+
+	/** Trace where each hand and foot meets the wall and publish IK targets in the anim snapshot, off at Minimal climb LOD */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true"))
+	bool bEnableClimbLimbIK = true;
+
+	/** Right hand's reach from the capsule centre, right and up in the climb pose. The left hand mirrors it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK"))
+	FVector2D ClimbHandIKOffset = FVector2D(25.f, 60.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK"))
+	FVector2D ClimbFootIKOffset = FVector2D(15.f, -70.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK", ClampMin = "0.0"))
+	float ClimbLimbIKTraceDistance = 100.f;
+
+	/** Between traces the last surfaces are reprojected under the moving limbs */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbLimbIKRefreshInterval = 0.1f;
+
+	/** Async line traces the limb IK may add to one climber's tick, on top of its movement queries */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK", ClampMin = "1", ClampMax = "4"))
+	int32 ClimbLimbIKMaxTracesPerTick = 4;
+
+	/** IK alpha change per second as limbs find or lose the surface */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|IK", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLimbIK", ClampMin = "0.0"))
+	float ClimbLimbIKBlendSpeed = 8.f;
+
+	/** Run distant climbers' surface, floor and ledge queries at a reduced rate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true"))
+	bool bEnableClimbLOD = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbLODEvaluationInterval = 0.25f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "0.0"))
+	float ClimbLODReducedDistance = 1500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "0.0"))
+	float ClimbLODMinimalDistance = 4000.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "0.0"))
+	float ClimbLODHysteresis = 200.f;
+
+	/** Climbers nobody has rendered recently are treated as this much further away */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "1.0"))
+	float ClimbLODHiddenDistanceScale = 2.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "1"))
+	int32 ClimbLODReducedSurfaceInterval = 2;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "1"))
+	int32 ClimbLODMinimalSurfaceInterval = 4;
+
+	/** Viewer distance at which the animation budget allocator gives this character half the significance of one at the camera */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", ClampMin = "1.0"))
+	float ClimbAnimationSignificanceFalloff = 1500.f;
+
+	/** Ticks between floor and ledge probes */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "1"))
+	int32 ClimbLODReducedProbeInterval = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "1"))
+	int32 ClimbLODMinimalProbeInterval = 8;
+
+	/** How quickly reduced climbers ease their snap surface toward the latest query result */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing|LOD", meta = (AllowPrivateAccess = "true", EditCondition = "bEnableClimbLOD", ClampMin = "0.0"))
+	float ClimbLODSurfaceBlendSpeed = 10.f;
+
+	/** Reuse the last surface sweep while the character barely moves and the surfaces it hit stay put */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bUseSurfaceCache = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", EditCondition = "bUseSurfaceCache", ClampMin = "0.0"))
+	float SurfaceCacheMaxLocationDelta = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", EditCondition = "bUseSurfaceCache", ClampMin = "0.0", Units = "Degrees"))
+	float SurfaceCacheMaxRotationDelta = 1.f;
+
+	/** Sweep again after this many cached ticks even if nothing seems to have changed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", EditCondition = "bUseSurfaceCache", ClampMin = "1"))
+	int32 SurfaceCacheForcedRefreshTicks = 10;
+
+	/** Load the climb montages only while near climbable geometry, off keeps them resident from BeginPlay */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Streaming", meta = (AllowPrivateAccess = "true"))
+	bool bStreamClimbMontages = true;
+
+	/** Start loading the montages once climbable or vaultable geometry is this close */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Streaming", meta = (AllowPrivateAccess = "true", EditCondition = "bStreamClimbMontages", ClampMin = "0.0"))
+	float ClimbMontagePreloadRadius = 600.f;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Streaming", meta = (AllowPrivateAccess = "true", EditCondition = "bStreamClimbMontages", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbMontageStreamingInterval = 0.5f;
+
+	/** Release the montages after this long away from anything climbable */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing|Streaming", meta = (AllowPrivateAccess = "true", EditCondition = "bStreamClimbMontages", ClampMin = "0.0", Units = "Seconds"))
+	float ClimbMontageReleaseDelay = 15.f;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* IdleToClimbMontage;
+	TSoftObjectPtr<UAnimMontage> IdleToClimbMontage;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* ClimbToTopMontage;
+	TSoftObjectPtr<UAnimMontage> ClimbToTopMontage;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* ClimbDownLedgeMontage;
+	TSoftObjectPtr<UAnimMontage> ClimbDownLedgeMontage;
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* VaultMontage;
+	TSoftObjectPtr<UAnimMontage> VaultMontage;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* HopUpMontage;
+	TSoftObjectPtr<UAnimMontage> HopUpMontage;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* HopDownMontage;
+	TSoftObjectPtr<UAnimMontage> HopDownMontage;
+
+	/**
+	 * Baked root motion of the climb montages. Dedicated servers, characters without an anim instance and every networked
+	 * player's predicted movement replay these instead of the montage, so owning client and server move the same way
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	UClimbRootMotionCache* RootMotionCache;
+
+	/** Use the baked curves everywhere, handy for checking them against the montages in PIE */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", EditCondition = "RootMotionCache != nullptr"))
+	bool bAlwaysUseBakedRootMotion = false;
 #pragma endregion
 
 public:
+	/** Climb requests are queued and run at the start of the next move, so they are replayed on the server and predicted on the owning client */
 	void ToggleClimbing(bool bEnableClimb);
 	void RequestHopping();
+	void RequestVaulting();
+	/** Skips the climb-entry montage, used when a simulated climber is promoted to a full character mid-climb */
+	void EnterClimbImmediately(const FVector& inVelocity);
 	bool IsClimbing() const;
+	/** A climb montage (entry, exit, hop or vault) is driving the character */
+	bool IsClimbActionPlaying() const;
 	FORCEINLINE FVector GetClimbableSurfaceNormal() const { return currentClimbableSurfaceNormal; }
 	FVector getUnrotatedClimbVelocity() const;
+	FORCEINLINE const FClimbAnimSnapshot& GetAnimSnapshot() const { return animSnapshot; }
+	FORCEINLINE EClimbLOD GetClimbLOD() const { return currentClimbLOD; }
+	FORCEINLINE float GetClimbViewerDistance() const { return climbViewerDistance; }
+	FORCEINLINE uint32 GetSurfaceCacheHits() const { return surfaceCacheHits; }
+	FORCEINLINE uint32 GetSurfaceCacheMisses() const { return surfaceCacheMisses; }
+	float GetSurfaceCacheHitRate() const;
+	FORCEINLINE const FClimbPerfCounters& GetPerfCounters() const { return perfCounters; }
+	FORCEINLINE void ResetPerfCounters() { perfCounters.Reset(); }
+
+#if WITH_EDITOR
+	/** Reads the action lengths off the baked root motion, or loads the montages, so it is meant for editor bakes on the CDO */
+	FClimbNavTraversalParams GetNavTraversalParams() const;
+#endif
+
+private:
+	friend struct FClimbMovementTestAccess;
+	friend struct FClimbBenchmarkAccess;
+};
+
+/** Saved move that carries climb requests, so entering, leaving, hopping and vaulting are predicted instead of corrected */
+class CLIMBINGSYSTEM_API FSavedMove_Climb : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	enum EClimbMoveFlags : uint8 {
+		FLAG_Climb = FLAG_Custom_0,
+		FLAG_StopClimb = FLAG_Custom_1,
+		FLAG_Hop = FLAG_Custom_2,
+		FLAG_Vault = FLAG_Custom_3,
+		FLAG_ClimbRequests = FLAG_Climb | FLAG_StopClimb | FLAG_Hop | FLAG_Vault
+	};
+
+	void Clear() override;
+	uint8 GetCompressedFlags() const override;
+	bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+
+private:
+	FVector savedClimbSurfaceNormal = FVector::ZeroVector;
+	float savedCombineMinNormalDot = 1.f;
+	bool bSavedWantsToClimb = false;
+	bool bSavedWantsToStopClimbing = false;
+	bool bSavedWantsToHop = false;
+	bool bSavedWantsToVault = false;
+};
+
+class CLIMBINGSYSTEM_API FNetworkPredictionData_Client_Climb : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Climb(const UCharacterMovementComponent& ClientMovement);
+	FSavedMovePtr AllocateNewMove() override;
 };
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ClimbDebugDrawSubsystem.generated.h"
+
+// climb trace visualization only exists in builds that can draw debug shapes at all
+#ifndef CLIMB_DEBUG_DRAW
+	#define CLIMB_DEBUG_DRAW (ENABLE_DRAW_DEBUG && !(UE_BUILD_SHIPPING || UE_BUILD_TEST))
+#endif
+
+UENUM()
+enum class EClimbDebugCategory : uint8 {
+	Surface,
+	Floor,
+	EyeHeight,
+	Ledge,
+	Hop,
+	Vault,
+	Count UMETA(Hidden)
+};
+
+/**
+ * Owns every climb trace shape for a world. Shapes live in a fixed ring buffer and are redrawn as
+ * one-frame lines each tick, so nothing is ever handed to the line batcher as persistent.
+ * Toggle categories with climb.Debug.<Category> and shape lifetime with climb.Debug.Duration.
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbDebugDrawSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static constexpr int32 MaxShapes = 1024;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+#if CLIMB_DEBUG_DRAW
+	static UClimbDebugDrawSubsystem* Get(const UWorld* world);
+	/** true when the category cvar is on, callers check this before adding shapes */
+	static bool IsCategoryEnabled(EClimbDebugCategory category);
+
+	/** bTimed shapes stay for climb.Debug.TimedDuration, everything else for climb.Debug.Duration (0 = one frame) */
+	void AddLine(const FVector& start, const FVector& end, const FColor& color, bool bTimed = false);
+	void AddPoint(const FVector& location, float size, const FColor& color, bool bTimed = false);
+	void AddCapsule(const FVector& center, float halfHeight, float radius, const FColor& color, bool bTimed = false);
+	void Clear();
+
+private:
+	enum class EShapeType : uint8 { Line, Point, Capsule };
+
+	struct FShape {
+		FVector A;
+		FVector B;
+		float Size;
+		float ExpireTime;
+		FColor Color;
+		EShapeType Type;
+	};
+
+	FShape& AllocateShape(EShapeType type, const FColor& color, bool bTimed);
+
+	TStaticArray<FShape, MaxShapes> shapes;
+	int32 nextShape = 0;
+	int32 numShapes = 0;
+#endif
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ClimbingSystem/ClimbingSystem.h"
+#include <atomic>
+
+/**
+ * Climb diagnostics. Every message that survives compile-time stripping lands in a fixed,
+ * lock-free ring buffer. It is only forwarded to the log output when LogClimbing's runtime
+ * verbosity allows it, so verbose climb logging costs a format and a copy, not a file write.
+ * The ring is dumped with climb.Log.Dump and automatically when the game crashes.
+ */
+namespace ClimbLog {
+	constexpr int32 RingCapacity = 512;
+	constexpr int32 MaxMessageLength = 200;
+	constexpr int32 RateLimitSlots = 256;
+
+	struct FEntry {
+		/** 0 while a writer owns the slot, otherwise the write index + 1 that filled it */
+		std::atomic<uint64> Sequence{ 0 };
+		double Time = 0.0;
+		uint64 Frame = 0;
+		ELogVerbosity::Type Verbosity = ELogVerbosity::Log;
+		TCHAR Message[MaxMessageLength] = {};
+	};
+
+	/** Multi-producer ring, writers never wait on each other or on a dump in progress */
+	class CLIMBINGSYSTEM_API FRing {
+	public:
+		void Write(ELogVerbosity::Type verbosity, const TCHAR* message);
+		/** Calls visitor oldest to newest with every entry that was not being rewritten while copied */
+		void ForEachEntry(TFunctionRef<void(double, uint64, ELogVerbosity::Type, const TCHAR*)> visitor) const;
+
+	private:
+		std::atomic<uint64> writeIndex{ 0 };
+		FEntry entries[RingCapacity];
+	};
+
+	CLIMBINGSYSTEM_API FRing& GetRing();
+
+	/** Records message in the ring and forwards it to LogClimbing when not suppressed at runtime */
+	CLIMBINGSYSTEM_API void Write(ELogVerbosity::Type verbosity, const TCHAR* message);
+	/** true at most once per interval seconds for each key, keys sharing a hash slot share the limit */
+	CLIMBINGSYSTEM_API bool ConsumeRateLimit(uint32 keyHash, float interval);
+
+	CLIMBINGSYSTEM_API void Dump(FOutputDevice& output);
+	/** Writes the ring to Saved/Logs/ClimbLog-<timestamp>.log and returns the file name */
+	CLIMBINGSYSTEM_API FString DumpToFile();
+
+	void RegisterCrashDump();
+	void UnregisterCrashDump();
+}
+
+#if NO_LOGGING
+	#define CLIMB_LOG(Verbosity, Format, ...)
+	#define CLIMB_LOG_RATE_LIMITED(Verbosity, Key, Interval, Format, ...)
+#else
+	#define CLIMB_LOG_COMPILED_IN(Verbosity) \
+		((ELogVerbosity::Verbosity & ELogVerbosity::VerbosityMask) <= ELogVerbosity::COMPILED_IN_MINIMUM_VERBOSITY && \
+		 (ELogVerbosity::Verbosity & ELogVerbosity::VerbosityMask) <= FLogCategoryLogClimbing::CompileTimeVerbosity)
+
+	/** Formats into a stack buffer so compiled-in climb logging does not allocate */
+	#define CLIMB_LOG(Verbosity, Format, ...) \
+		do { \
+			if constexpr(CLIMB_LOG_COMPILED_IN(Verbosity)) { \
+				TCHAR climbLogMessage[ClimbLog::MaxMessageLength]; \
+				FCString::Snprintf(climbLogMessage, ClimbLog::MaxMessageLength, Format, ##__VA_ARGS__); \
+				ClimbLog::Write(ELogVerbosity::Verbosity, climbLogMessage); \
+			} \
+		} while(0)
+
+	/** CLIMB_LOG that fires at most once per Interval seconds for each Key, e.g. an actor or a name */
+	#define CLIMB_LOG_RATE_LIMITED(Verbosity, Key, Interval, Format, ...) \
+		do { \
+			if constexpr(CLIMB_LOG_COMPILED_IN(Verbosity)) { \
+				if(ClimbLog::ConsumeRateLimit(GetTypeHash(Key), Interval)) { \
+					CLIMB_LOG(Verbosity, Format, ##__VA_ARGS__); \
+				} \
+			} \
+		} while(0)
+#endif
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "ClimbMassFragments.generated.h"
+
+class AClimbingSystemCharacter;
+
+UENUM()
+enum class EClimbMassMode : uint8 {
+	Climbing,
+	Detached
+};
+
+/** Averaged climbable surface in front of the agent, the Mass counterpart of currentClimbableSurfaceLocation/Normal */
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbSurfaceFragment : public FMassFragment {
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::ZeroVector;
+	int32 NumHits = 0;
+	/** False until the first sweep comes back, Location, Normal and NumHits mean nothing before that */
+	bool bHasResult = false;
+	FTraceHandle PendingTrace;
+};
+
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbStateFragment : public FMassFragment {
+	GENERATED_BODY()
+
+	FVector Velocity = FVector::ZeroVector;
+
+	/** Climb input along the wall, X is right and Y is up */
+	FVector2D MoveInput = FVector2D::ZeroVector;
+
+	EClimbMassMode Mode = EClimbMassMode::Climbing;
+};
+
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbMassAgentTag : public FMassTag {
+	GENERATED_BODY()
+};
+
+/** Swapped in for FClimbMassAgentTag while a full character stands in for the agent, so the agent is not simulated twice */
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbMassPromotedTag : public FMassTag {
+	GENERATED_BODY()
+};
+
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbPromotedCharacterFragment : public FMassFragment {
+	GENERATED_BODY()
+
+	TWeakObjectPtr<AClimbingSystemCharacter> Character;
+};
+
+/** Per-archetype climb tuning, mirrors the UCustomMovementComponent defaults */
+USTRUCT()
+struct CLIMBINGSYSTEM_API FClimbMassParams : public FMassSharedFragment {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	TArray<TEnumAsByte<EObjectTypeQuery>> ClimableSurfaceTraceTypes;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float ClimbCapsuleTraceRadius = 50.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float ClimbCapsuleTraceHalfHeight = 72.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float MaxClimbSpeed = 100.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float MaxClimbAcceleration = 300.f;
+
+	/** Agents closer than this to a player pawn are swapped for a full character */
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float PromotionDistance = 2000.f;
+
+	/** Promoted characters further than this from every player pawn turn back into agents, kept above PromotionDistance so climbers on the boundary do not swap every frame */
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	float DemotionDistance = 2500.f;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	TSubclassOf<AClimbingSystemCharacter> PromotedCharacterClass;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "ClimbMassProcessors.generated.h"
+
+/**
+ * Consumes last frame's surface sweeps and issues this frame's as one async batch,
+ * the Mass counterpart of TraceClimbableSurfaces + processClimbableSurfaceInfo
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbSurfaceQueryProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UClimbSurfaceQueryProcessor();
+
+protected:
+	void ConfigureQueries() override;
+	void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Integrates climb velocity, rotation and surface snapping over whole chunks in parallel,
+ * the Mass counterpart of PhysClimb, GetClimbRotation and snapMovementToSurface
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UClimbMovementProcessor();
+
+protected:
+	void ConfigureQueries() override;
+	void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Swaps agents near a player for a full AClimbingSystemCharacter so close-up climbers get montages, hops and vaults,
+ * and swaps them back once every player has moved away. The agent entity is kept while promoted, so demotion only
+ * hands the character's state back to it.
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UClimbPromotionProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UClimbPromotionProcessor();
+
+protected:
+	void ConfigureQueries() override;
+	void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+	void DemoteCharacters(FMassEntityManager& EntityManager, FMassExecutionContext& Context, TConstArrayView<FVector> playerLocations);
+	void PromoteAgents(FMassEntityManager& EntityManager, FMassExecutionContext& Context, TConstArrayView<FVector> playerLocations);
+
+	/** Spawning a character costs far more than a Mass agent, a crowd walking into range is promoted closest first over several frames */
+	UPROPERTY(EditDefaultsOnly, Config, Category = "Climbing", meta = (ClampMin = "1"))
+	int32 MaxPromotionsPerFrame = 2;
+
+	FMassEntityQuery EntityQuery;
+	FMassEntityQuery PromotedQuery;
+};
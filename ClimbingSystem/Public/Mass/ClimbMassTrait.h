@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "Mass/ClimbMassFragments.h"
+#include "ClimbMassTrait.generated.h"
+
+/**
+ * Adds the climbing fragments to a Mass entity config so agents crawl walls without a full character
+ */
+UCLASS(meta = (DisplayName = "Climbing"))
+class CLIMBINGSYSTEM_API UClimbMassTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+	void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Climbing")
+	FClimbMassParams Params;
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EClimbInputEvent : uint8 {
+	GroundMove,
+	ClimbMove,
+	Look,
+	ClimbAction,
+	ClimbHopAction,
+	Jump,
+	StopJumping
+};
+
+struct FClimbInputRecord {
+	uint32 Frame = 0;
+	EClimbInputEvent Event = EClimbInputEvent::GroundMove;
+	FVector2f Value = FVector2f::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FClimbInputRecord& record);
+};
+
+/**
+ * Records the climb character's input against a fixed-timestep frame counter into a compact binary log and replays it.
+ * Each frame folds the quantized pose into a trajectory checksum, so two runs can be compared both on timing and on behaviour.
+ */
+class CLIMBINGSYSTEM_API FClimbInputRecorder {
+public:
+	enum class EMode : uint8 {
+		Idle,
+		Recording,
+		Replaying
+	};
+
+	void StartRecording(const FString& inLogPath, float inFixedDeltaTime, const FTransform& inStartTransform, const FRotator& inStartControlRotation);
+	bool StartReplay(const FString& inLogPath);
+	void Stop();
+
+	void Record(EClimbInputEvent event, const FVector2D& value);
+
+	/** Folds the pose reached since the last call into the checksum and moves on to the next frame */
+	void AdvanceFrame(const FVector& location, const FRotator& rotation, bool bIsClimbing);
+
+	/** Hands every recorded event for the current frame to dispatch, in recorded order */
+	template<typename FuncType>
+	void DispatchFrameEvents(FuncType&& dispatch) {
+		while(replayCursor < records.Num() && records[replayCursor].Frame == currentFrame) {
+			const auto& record = records[replayCursor++];
+			dispatch(record.Event, FVector2D(record.Value));
+		}
+	}
+
+	FORCEINLINE bool IsRecording() const { return mode == EMode::Recording; }
+	FORCEINLINE bool IsReplaying() const { return mode == EMode::Replaying; }
+	FORCEINLINE bool IsReplayFinished() const { return IsReplaying() && currentFrame >= recordedFrameCount; }
+	FORCEINLINE const FTransform& GetStartTransform() const { return startTransform; }
+	FORCEINLINE const FRotator& GetStartControlRotation() const { return startControlRotation; }
+	FORCEINLINE uint32 GetChecksum() const { return checksum; }
+
+private:
+	void SaveLog();
+	void SaveReplayReport() const;
+	void SetFixedTimeStep(bool bEnable);
+
+	EMode mode = EMode::Idle;
+	FString logPath;
+	float fixedDeltaTime = 1.f / 60.f;
+	FTransform startTransform;
+	FRotator startControlRotation;
+
+	TArray<FClimbInputRecord> records;
+	int32 replayCursor = 0;
+	uint32 currentFrame = 0;
+	uint32 recordedFrameCount = 0;
+	uint32 recordedChecksum = 0;
+	uint32 checksum = 0;
+
+	TArray<float> frameTimesMs;
+	double lastFrameSeconds = 0.0;
+
+	bool bPreviousUseFixedTimeStep = false;
+	double previousFixedDeltaTime = 0.0;
+};